@@ -12,230 +12,3679 @@
 
 #include <iostream>
 #include <fstream>
-#include <sstream>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <charconv>
+#include <climits>
+#include <stdexcept>
+#include <cstdint>
+#include <algorithm>
+#include <thread>
+#include <functional>
+#include <exception>
+#include <cstring>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <type_traits>
+#include <cmath>
+#include <queue>
+
+// x86 builds get vectorized csv tokenizing and slack kernels, SSE2 is always there on x86-64
+// and AVX2 is picked at runtime when the cpu supports it
+#if defined(__x86_64__) || defined(_M_X64)
+#define ELIXIR_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define ELIXIR_TARGET_AVX2
+#else
+#define ELIXIR_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
-// Task structure for project management software
-struct Task {
-    // Task information
-    string name;
-    int duration;
-    vector<string> dependencies;
+// Names are interned in the project's symbol table and referred to by id
+using NameId = uint32_t;
+const NameId noName = UINT32_MAX;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Time types                                                                           //
+// Durations and every time computed from them share one type, picked on the command   //
+// line (see --time). The loaders, passes and writers are templates instantiated for   //
+// each type, so none of them pays for the types it isn't using:                       //
+//     int32   whole time units, the compact default                                    //
+//     int64   whole time units, for plans whose horizon doesn't fit in 32 bits        //
+//     fixed   time units with up to 3 decimals, which still add up exactly            //
+//     double  any fractional time units                                                //
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Fixed point time, counted in thousandths of a time unit
+struct FixedTime {
+    int64_t thousandths = 0;
+
+    friend FixedTime operator+(FixedTime a, FixedTime b) { return { a.thousandths + b.thousandths }; }
+    friend FixedTime operator-(FixedTime a, FixedTime b) { return { a.thousandths - b.thousandths }; }
+    friend bool operator==(FixedTime a, FixedTime b) { return a.thousandths == b.thousandths; }
+    friend bool operator!=(FixedTime a, FixedTime b) { return a.thousandths != b.thousandths; }
+    friend bool operator<(FixedTime a, FixedTime b) { return a.thousandths < b.thousandths; }
+    friend bool operator>(FixedTime a, FixedTime b) { return a.thousandths > b.thousandths; }
+    friend bool operator<=(FixedTime a, FixedTime b) { return a.thousandths <= b.thousandths; }
+    friend bool operator>=(FixedTime a, FixedTime b) { return a.thousandths >= b.thousandths; }
+};
+
+// How a time type is named, parsed from the csv and written back out
+// id is what compiled project files record the type as
+template <typename Time>
+struct TimeTraits;
+
+template <typename Time>
+struct IntegerTimeTraits {
+    static constexpr const char* description = "a whole number";
+
+    static Time max() { return numeric_limits<Time>::max(); }
+
+    static bool parse(string_view text, Time& value) {
+        const char* end = text.data() + text.size();
+        auto [parsedEnd, error] = from_chars(text.data(), end, value);
+        return error == errc() && parsedEnd == end;
+    }
+
+    static void write(ostream& out, Time value) { out << value; }
+    static double toDouble(Time value) { return (double)value; }
+};
+
+template <>
+struct TimeTraits<int32_t> : IntegerTimeTraits<int32_t> {
+    static constexpr const char* name = "int32";
+    static constexpr uint32_t id = 1;
+};
+
+template <>
+struct TimeTraits<int64_t> : IntegerTimeTraits<int64_t> {
+    static constexpr const char* name = "int64";
+    static constexpr uint32_t id = 2;
+};
+
+template <>
+struct TimeTraits<FixedTime> {
+    static constexpr const char* name = "fixed";
+    static constexpr uint32_t id = 3;
+    static constexpr const char* description = "a number with at most 3 decimals";
+
+    static FixedTime max() { return { INT64_MAX }; }
+
+    // A whole number optionally followed by '.' and 1 to 3 decimals, eg. "12", "-0.5", "1.125"
+    static bool parse(string_view text, FixedTime& value) {
+        bool negative = !text.empty() && text[0] == '-';
+        if (negative) text.remove_prefix(1);
+        size_t point = text.find('.');
+        string_view whole = text.substr(0, point);
+        string_view decimals = point == string_view::npos ? string_view() : text.substr(point + 1);
+        if (whole.empty() || (point != string_view::npos && (decimals.empty() || decimals.size() > 3))) return false;
+
+        int64_t units = 0;
+        auto [wholeEnd, error] = from_chars(whole.data(), whole.data() + whole.size(), units);
+        if (error != errc() || wholeEnd != whole.data() + whole.size() || whole[0] == '-' || units > INT64_MAX / 1000 - 1) return false;
+        int64_t thousandths = 0;
+        for (size_t k = 0; k < 3; ++k) {
+            char digit = k < decimals.size() ? decimals[k] : '0';
+            if (digit < '0' || digit > '9') return false;
+            thousandths = thousandths * 10 + (digit - '0');
+        }
+
+        value.thousandths = units * 1000 + thousandths;
+        if (negative) value.thousandths = -value.thousandths;
+        return true;
+    }
+
+    // Writes the shortest form, eg. "3", "1.5", "-0.125"
+    static void write(ostream& out, FixedTime value) {
+        uint64_t magnitude = value.thousandths < 0 ? 0 - (uint64_t)value.thousandths : (uint64_t)value.thousandths;
+        if (value.thousandths < 0) out << '-';
+        out << magnitude / 1000;
+        uint64_t decimals = magnitude % 1000;
+        if (decimals == 0) return;
+        char digits[4] = { char('0' + decimals / 100), char('0' + decimals / 10 % 10), char('0' + decimals % 10), '\0' };
+        for (int k = 2; k > 0 && digits[k] == '0'; --k) digits[k] = '\0';
+        out << '.' << digits;
+    }
+
+    static double toDouble(FixedTime value) { return value.thousandths / 1000.0; }
+};
+
+template <>
+struct TimeTraits<double> {
+    static constexpr const char* name = "double";
+    static constexpr uint32_t id = 4;
+    static constexpr const char* description = "a number";
+
+    static double max() { return numeric_limits<double>::max(); }
+
+    static bool parse(string_view text, double& value) {
+        const char* end = text.data() + text.size();
+        auto [parsedEnd, error] = from_chars(text.data(), end, value);
+        return error == errc() && parsedEnd == end && isfinite(value);
+    }
+
+    // Writes the shortest text that reads back as the same number
+    static void write(ostream& out, double value) {
+        char text[32];
+        auto [end, error] = to_chars(text, text + sizeof(text), value);
+        out.write(text, end - text);
+    }
+
+    static double toDouble(double value) { return value; }
+};
+
+// Wraps a time so that it is written in its csv form, eg. file << showTime(ES)
+template <typename Time>
+struct ShownTime {
+    Time value;
+};
+
+template <typename Time>
+ShownTime<Time> showTime(Time value) {
+    return { value };
+}
+
+template <typename Time>
+ostream& operator<<(ostream& out, ShownTime<Time> time) {
+    TimeTraits<Time>::write(out, time.value);
+    return out;
+}
+
+// Calls visit(Time()) for the time type with the given name or id, returns false if there is none
+template <typename Visit>
+bool visitTimeType(const string& name, uint32_t id, Visit visit) {
+    auto tryType = [&](auto zero) {
+        using Time = decltype(zero);
+        if (name != TimeTraits<Time>::name && id != TimeTraits<Time>::id) return false;
+        visit(zero);
+        return true;
+    };
+    return tryType(int32_t()) || tryType(int64_t()) || tryType(FixedTime()) || tryType(double());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Working calendars                                                                    //
+// Without calendars every time unit is a working one. A calendar (see --calendars)    //
+// only works some of them: the working days of a week of 7 time units that repeats   //
+// from time 0, minus its holidays. A task takes duration working units of its own     //
+// calendar and neither starts nor finishes on a unit it doesn't work, eg. 3 units      //
+// starting on a friday of a monday to friday week finish at the end of tuesday.       //
+// Lags stay elapsed time units, slack and free float count working units of the task. //
+//                                                                                      //
+// The passes work on working unit numbers: W(t), how many working units there are    //
+// before time t, and its inverse U(k), the time of working unit k. Both are prefix    //
+// tables up to the first whole week past the last holiday, and past that the weeks    //
+// all look alike and a division finds the unit, so either way they take O(1).         //
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Calendars are identified by their position in the calendar list, 0 is the project calendar
+using CalendarId = uint16_t;
+
+// Floor of a / b for b > 0
+inline int64_t floorDiv(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return q - (a % b < 0);
+}
+
+// Which time units a task works, see above
+class WorkCalendar {
+public:
+    static constexpr int64_t maxHoliday = (1 << 24) - 1; // Keeps the prefix tables to a few dozen megabytes
+
+    // Bit d of week is set if unit d of every week is a working one, at least one must be
+    // Holidays must be in [0, maxHoliday], in any order
+    WorkCalendar(uint8_t week, vector<int64_t> holidays) : week(week), holidays(move(holidays)) {
+        sort(this->holidays.begin(), this->holidays.end());
+        this->holidays.erase(unique(this->holidays.begin(), this->holidays.end()), this->holidays.end());
+        for (int d = 0; d < 7; ++d) {
+            weekBefore[d] = weekWork;
+            if (week >> d & 1) weekUnits[weekWork++] = (uint8_t)d;
+        }
+        weekBefore[7] = weekWork;
+
+        span = this->holidays.empty() ? 0 : (this->holidays.back() / 7 + 1) * 7;
+        before.resize(span + 1);
+        size_t next = 0;
+        for (int64_t t = 0; t < span; ++t) {
+            before[t] = (uint32_t)units.size();
+            bool holiday = next < this->holidays.size() && this->holidays[next] == t;
+            if (holiday) next++;
+            else if (week >> (t % 7) & 1) units.push_back((uint32_t)t);
+        }
+        before[span] = (uint32_t)units.size();
+    }
+
+    uint8_t workWeek() const { return week; }
+    const vector<int64_t>& holidayList() const { return holidays; }
+
+    // W(t), the number of working units in [0, t), or minus those in [t, 0) for t < 0
+    int64_t workBefore(int64_t t) const {
+        if (t >= 0 && t < span) return before[t];
+        int64_t base = t < 0 ? 0 : span;
+        int64_t weeks = floorDiv(t - base, 7);
+        return (t < 0 ? 0 : before[span]) + weeks * weekWork + weekBefore[t - base - weeks * 7];
+    }
+
+    // U(k), the time of working unit k (counting from 0), the inverse of workBefore
+    int64_t workUnit(int64_t k) const {
+        if (k >= 0 && k < (int64_t)units.size()) return units[k];
+        int64_t base = k < 0 ? 0 : span;
+        int64_t baseWork = k < 0 ? 0 : (int64_t)units.size();
+        int64_t weeks = floorDiv(k - baseWork, weekWork);
+        return base + weeks * 7 + weekUnits[k - baseWork - weeks * weekWork];
+    }
+
+    bool works(int64_t t) const { return workBefore(t + 1) > workBefore(t); }
+
+private:
+    uint8_t week;
+    vector<int64_t> holidays;  // Sorted, without duplicates
+    int64_t weekWork = 0;      // Working units in a week
+    uint8_t weekBefore[8];     // Working units before unit d of a week
+    uint8_t weekUnits[7];      // Unit of a week of every working unit in it
+    int64_t span;              // The tables cover [0, span), a whole number of weeks
+    vector<uint32_t> before;   // W(t) for t in [0, span]
+    vector<uint32_t> units;    // U(k) for the working units before span
+};
+
+// Calendars by name as read from a calendars csv, the first one is the project calendar
+struct CalendarList {
+    vector<string> names;
+    vector<WorkCalendar> calendars;
+};
+
+// Resources are identified by their position in the resources csv
+using ResourceId = uint16_t;
+
+// Amount of a resource a task holds from its start to its finish
+struct ResourceDemand {
+    ResourceId resource;
+    uint32_t amount;
+};
+
+// Resources by name as read from a resources csv, with how much there is of every one
+struct ResourceList {
+    vector<string> names;
+    vector<uint32_t> capacities;
+};
+
+// Date constraint of a task, written as in "SNET:5", which holds the task to the time after
+// the ':' on top of its dependencies. The forward pass applies the ones that push the task
+// later and the backward pass the ones that pull it earlier, a Must constraint is both
+enum ConstraintType : uint8_t {
+    NoConstraint = 0,
+    StartNoEarlier = 1,  // SNET
+    StartNoLater = 2,    // SNLT
+    FinishNoEarlier = 3, // FNET
+    FinishNoLater = 4,   // FNLT
+    MustStartOn = 5,     // MSO
+    MustFinishOn = 6,    // MFO
+};
+
+// Tasks are identified by their position in the task list
+using TaskId = uint32_t;
+const TaskId noTask = UINT32_MAX;
+
+// Task list for project management software, stored as a structure of arrays where field[i] is
+// the field of task i. Each pass and kernel streams through just the columns it reads and
+// writes, instead of dragging whole task records through the cache
+template <typename Time>
+struct TaskTable {
+    // Task information
+    vector<NameId> name; // Resolved to text through the project's symbol table only when writing output
+    vector<Time> duration;
+
+    // Calculation for critical-path-method
+    vector<Time> ES; // Early start
+    vector<Time> EF; // Early finish
+    vector<Time> LS; // Late start
+    vector<Time> LF; // Late finish
+    vector<Time> slack; // The amount of time a task can be delayed without affecting duration, 
+                        // tasks not on the critical path with have a slack of > 0 while critical
+                        // tasks have a slack = 0, or < 0 when they can't meet a constraint or the deadline
+    vector<Time> freeFloat; // The amount of time a task can be delayed without delaying any of its successors
+    vector<uint8_t> critical; // 1 for tasks on the critical path (slack <= 0), otherwise 0
+    vector<CalendarId> calendar; // Calendar the task works in, an index into calendars
+    vector<uint8_t> constraint;  // ConstraintType of the task
+    vector<Time> constraintTime; // Time its constraint holds it to
+    vector<uint32_t> firstDemand; // The resources the task needs are demands[firstDemand, firstDemand + demandCount)
+    vector<uint16_t> demandCount;
+
+    // Every calendar a task works in, empty when every time unit is a working one
+    // Not a column, the tasks only refer to it
+    vector<WorkCalendar> calendars;
+
+    // Resource demands of every task back to back and how much there is of every resource,
+    // both empty when the project has no resources
+    vector<ResourceDemand> demands;
+    vector<uint32_t> capacities;
+
+    // Latest finish of the project, every task without successors has it as its LF
+    // TimeTraits<Time>::max() if there is none and the LF of those tasks is their EF
+    Time deadline = TimeTraits<Time>::max();
+
+    // Whether any task has a constraint or the project a deadline, see findConstraints()
+    bool constrained = false;
+
+    size_t size() const { return name.size(); }
+
+    // Must be called whenever the constraints or the deadline change
+    void findConstraints() {
+        constrained = deadline != TimeTraits<Time>::max() || any_of(constraint.begin(), constraint.end(), [](uint8_t type) { return type != NoConstraint; });
+    }
+
+    void reserve(size_t count) {
+        forEachColumn([&](auto& column) { column.reserve(count); });
+    }
+
+    // Adds a task with an empty schedule and returns its id
+    TaskId add(NameId taskName, Time taskDuration) {
+        forEachColumn([](auto& column) { column.emplace_back(); });
+        name.back() = taskName;
+        duration.back() = taskDuration;
+        return (TaskId)(size() - 1);
+    }
+
+    // Copies task from over task to
+    void copy(TaskId from, TaskId to) {
+        forEachColumn([&](auto& column) { column[to] = column[from]; });
+    }
+
+    void removeLast() {
+        forEachColumn([](auto& column) { column.pop_back(); });
+    }
+
+    // Reorders the tasks so that task i becomes the task that was order[i]
+    void permute(const vector<TaskId>& order) {
+        forEachColumn([&](auto& column) {
+            auto permuted = column;
+            for (size_t i = 0; i < order.size(); ++i) permuted[i] = column[order[i]];
+            column.swap(permuted);
+        });
+    }
+
+private:
+    template <typename Visit>
+    void forEachColumn(Visit visit) {
+        visit(name);
+        visit(duration);
+        visit(ES);
+        visit(EF);
+        visit(LS);
+        visit(LF);
+        visit(slack);
+        visit(freeFloat);
+        visit(critical);
+        visit(calendar);
+        visit(constraint);
+        visit(constraintTime);
+        visit(firstDemand);
+        visit(demandCount);
+    }
+};
+
+// Contiguous run of task ids, ie. one row of a compressed sparse row array
+struct TaskRange {
+    const TaskId* first;
+    const TaskId* last;
+
+    const TaskId* begin() const { return first; }
+    const TaskId* end() const { return last; }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+};
+
+// Dependency graph in compressed sparse row (CSR) form, stored for both directions
+// The predecessors (dependencies) of task t are preds[predOffsets[t]] up to but excluding
+// preds[predOffsets[t + 1]], and the same goes for the successors. Every edge is just one
+// uint32_t per direction and the passes scan flat arrays instead of per-task vectors
+struct TaskGraph {
+    vector<uint32_t> predOffsets;
+    vector<TaskId> preds;
+    vector<uint32_t> succOffsets;
+    vector<TaskId> succs;
+
+    size_t size() const { return predOffsets.empty() ? 0 : predOffsets.size() - 1; }
+
+    TaskRange predecessors(TaskId t) const {
+        return { preds.data() + predOffsets[t], preds.data() + predOffsets[t + 1] };
+    }
+
+    TaskRange successors(TaskId t) const {
+        return { succs.data() + succOffsets[t], succs.data() + succOffsets[t + 1] };
+    }
+};
+
+// How a dependency ties a task to the task it depends on, written as in "b:SS+2"
+// The first letter is the end of the dependency and the second the end of the task that has
+// to wait for it, eg. SS: the task can start once the dependency has started. The lag is added
+// on top, a negative lag (a lead) lets the task begin before that
+enum LinkType : uint8_t {
+    FinishToStart = 0,  // FS, a plain dependency
+    StartToStart = 1,   // SS
+    FinishToFinish = 2, // FF
+    StartToFinish = 3,  // SF
+};
+
+const uint8_t linkFromStart = 1; // Bit of a LinkType: waits for the start of the dependency, not its finish
+const uint8_t linkToFinish = 2;  // Bit of a LinkType: holds back the finish of the task, not its start
+
+// Types and lags of one row of dependencies or successors, entry k belongs to task k of the row
+template <typename Time>
+struct LinkRange {
+    const uint8_t* types;
+    const Time* lags;
+};
+
+// Dependency graph whose edges carry a link type and lag, in arrays running alongside preds
+// and succs. A plain csv dependency is FinishToStart with a lag of 0
+template <typename Time>
+struct LinkedTaskGraph : TaskGraph {
+    vector<uint8_t> predTypes;
+    vector<Time> predLags;
+    vector<uint8_t> succTypes;
+    vector<Time> succLags;
+    bool linked = false; // Whether any edge is not a plain dependency, see findLinks()
+
+    // Sets linked, the passes skip the type and lag arrays of a graph without links
+    void findLinks() {
+        linked = false;
+        for (size_t e = 0; e < predTypes.size() && !linked; ++e) {
+            linked = predTypes[e] != FinishToStart || predLags[e] != Time();
+        }
+    }
+
+    LinkRange<Time> predLinks(TaskId t) const {
+        return { predTypes.data() + predOffsets[t], predLags.data() + predOffsets[t] };
+    }
+
+    LinkRange<Time> succLinks(TaskId t) const {
+        return { succTypes.data() + succOffsets[t], succLags.data() + succOffsets[t] };
+    }
+};
+
+// Read-only memory mapping of a whole file
+// The file is mapped rather than read so that loading never copies the text, anything that
+// points into data() stays valid for as long as this object (or the one it is moved to) lives
+class MappedFile {
+public:
+    MappedFile() {}
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept : mapData(other.mapData), mapSize(other.mapSize) {
+        other.mapData = nullptr;
+        other.mapSize = 0;
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            mapData = other.mapData;
+            mapSize = other.mapSize;
+            other.mapData = nullptr;
+            other.mapSize = 0;
+        }
+        return *this;
+    }
+
+    // Maps the file into memory, returns false if the file can't be opened or mapped
+    // An empty file maps successfully to an empty view
+    bool open(const string& filename) {
+        close();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            return false;
+        }
+        if (fileSize.QuadPart == 0) {
+            CloseHandle(file);
+            return true;
+        }
+
+        // The view keeps the mapping alive on its own, so both handles can be closed right away
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr) return false;
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (view == nullptr) return false;
+
+        mapData = static_cast<const char*>(view);
+        mapSize = (size_t)fileSize.QuadPart;
+#else
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            ::close(fd);
+            return false;
+        }
+        if (info.st_size == 0) {
+            ::close(fd);
+            return true;
+        }
+
+        // The mapping stays valid after the descriptor is closed
+        void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED) return false;
+
+        // The file is read front to back once, let the kernel read ahead aggressively
+        madvise(view, (size_t)info.st_size, MADV_SEQUENTIAL);
+
+        mapData = static_cast<const char*>(view);
+        mapSize = (size_t)info.st_size;
+#endif
+        return true;
+    }
+
+    void close() {
+        if (mapData == nullptr) return;
+#ifdef _WIN32
+        UnmapViewOfFile(mapData);
+#else
+        munmap(const_cast<char*>(mapData), mapSize);
+#endif
+        mapData = nullptr;
+        mapSize = 0;
+    }
+
+    const char* data() const { return mapData; }
+    size_t size() const { return mapSize; }
+    string_view view() const { return string_view(mapData, mapSize); }
+
+private:
+    const char* mapData = nullptr;
+    size_t mapSize = 0;
+};
+
+// 64 bit hash of a name, mixing 8 bytes at a time
+// The hash is part of the compiled project file format, so it must not depend on the compiler
+inline uint64_t hashName(string_view name) {
+    uint64_t h = 0x9E3779B97F4A7C15ull ^ name.size();
+    size_t i = 0;
+    for (; i + 8 <= name.size(); i += 8) {
+        uint64_t word;
+        memcpy(&word, name.data() + i, 8);
+        h = (h ^ word) * 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 29;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, name.data() + i, name.size() - i);
+    h = (h ^ tail) * 0x94D049BB133111EBull;
+    return h ^ (h >> 32);
+}
+
+// Bump allocator for string storage
+// Strings are copied back to back into large blocks and only freed all at once, so storing a
+// name costs a memcpy instead of a heap allocation, and the stored bytes never move
+class StringArena {
+public:
+    string_view store(string_view s) {
+        if (s.size() > remaining) {
+            size_t blockSize = max(minBlockSize, s.size());
+            blocks.emplace_back(new char[blockSize]);
+            cursor = blocks.back().get();
+            remaining = blockSize;
+        }
+        if (!s.empty()) memcpy(cursor, s.data(), s.size());
+        string_view stored(cursor, s.size());
+        cursor += s.size();
+        remaining -= s.size();
+        return stored;
+    }
+
+private:
+    static constexpr size_t minBlockSize = 1 << 20;
+    vector<unique_ptr<char[]>> blocks;
+    char* cursor = nullptr;
+    size_t remaining = 0;
+};
+
+// Symbol table storing every distinct name once in an arena and handing out dense ids
+// Lookups go through an open addressing hash table of ids with linear probing, kept at most
+// half full, so a lookup is a hash plus (usually) one string comparison
+class SymbolTable {
+public:
+    // Returns the id of the name, adding it first if it is new
+    NameId intern(string_view name) {
+        if ((names.size() + 1) * 2 > slots.size()) grow();
+        size_t slot = findSlot(name, hashName(name));
+        if (slots[slot] == noName) {
+            if (names.size() >= noName) throw runtime_error("Too many names");
+            slots[slot] = (NameId)names.size();
+            names.push_back(arena.store(name));
+        }
+        return slots[slot];
+    }
+
+    // Returns the id of the name or noName if it was never interned
+    // Doesn't modify the table, so any number of threads may look up names at once
+    NameId find(string_view name) const {
+        if (slots.empty()) return noName;
+        return slots[findSlot(name, hashName(name))];
+    }
+
+    string_view name(NameId id) const { return names[id]; }
+    size_t size() const { return names.size(); }
+    const vector<NameId>& hashSlots() const { return slots; }
+
+    // Rebuilds the table from a serialized one, see the compiled project files
+    // The names are count views into blob given by offsets, and slotData is the hash table
+    void load(const char* blob, const uint64_t* offsets, size_t count, const NameId* slotData, size_t slotCount) {
+        const char* base = arena.store(string_view(blob, offsets[count])).data();
+        names.resize(count);
+        for (size_t i = 0; i < count; ++i) names[i] = string_view(base + offsets[i], offsets[i + 1] - offsets[i]);
+        slots.assign(slotData, slotData + slotCount);
+    }
+
+    // Whether every name sits in exactly one slot, where a lookup of it finds it, and there is
+    // an empty slot left so that a lookup of a name that isn't there ends
+    // A loaded table comes from a file that may be corrupt, and lookups trust the table
+    bool consistent() const {
+        size_t used = 0;
+        for (NameId id : slots) used += id != noName;
+        if (used != names.size() || (!slots.empty() && used == slots.size())) return false;
+        for (NameId id = 0; id < names.size(); ++id) {
+            if (slots[findSlot(names[id], hashName(names[id]))] != id) return false;
+        }
+        return true;
+    }
+
+private:
+    // Slot holding the name, or the empty slot where it would go
+    size_t findSlot(string_view name, uint64_t hash) const {
+        size_t mask = slots.size() - 1;
+        for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+            if (slots[slot] == noName || names[slots[slot]] == name) return slot;
+        }
+    }
+
+    // Doubles the hash table and reinserts every id
+    void grow() {
+        slots.assign(max<size_t>(16, slots.size() * 2), noName);
+        size_t mask = slots.size() - 1;
+        for (NameId id = 0; id < names.size(); ++id) {
+            size_t slot = hashName(names[id]) & mask;
+            while (slots[slot] != noName) slot = (slot + 1) & mask;
+            slots[slot] = id;
+        }
+    }
+
+    StringArena arena;
+    vector<string_view> names;
+    vector<NameId> slots;
+};
+
+// Project structure holding the task list, the names of the tasks and the dependency graph
+// between tasks. Every task name is interned once in the symbol table, and taskByName maps a
+// name id back to the first task with that name, so looking up a task by name is O(1) on average
+template <typename Time>
+struct Project {
+    SymbolTable names;
+    vector<TaskId> taskByName;
+    TaskTable<Time> tasks;
+    LinkedTaskGraph<Time> graph;
+    vector<TaskId> readOrder; // Id of every task in the order they were read, empty unless renumbered
+};
+
+// Returns the id of the k-th task read, the outputs list the tasks in that order
+template <typename Time>
+inline TaskId getTaskInReadOrder(const Project<Time>& project, size_t k) {
+    return project.readOrder.empty() ? (TaskId)k : project.readOrder[k];
+}
+
+// Fills taskByName once every task is known, the first task with a given name wins
+template <typename Time>
+void indexTasksByName(Project<Time>& project) {
+    project.taskByName.assign(project.names.size(), noTask);
+    for (TaskId i = 0; i < project.tasks.size(); ++i) {
+        TaskId& entry = project.taskByName[project.tasks.name[i]];
+        if (entry == noTask) entry = i;
+    }
+}
+
+
+// Helper function to get the index of a task in the tasklist by name
+template <typename Time>
+TaskId getTaskIndex(string_view name, const Project<Time>& project) {
+    NameId id = project.names.find(name);
+    if (id == noName || project.taskByName[id] == noTask) throw runtime_error("Task not found: " + string(name));
+    return project.taskByName[id];
+}
+
+// Populate successors for all tasks
+// The dependencies of a task means that the task is the successor of the dependencies,
+// so the successor arrays are the predecessor arrays transposed with a counting sort
+void populateSuccessors(TaskGraph& graph) {
+    size_t n = graph.size();
+
+    // Count the successors of every task, then turn the counts into offsets
+    graph.succOffsets.assign(n + 1, 0);
+    for (TaskId d : graph.preds) graph.succOffsets[d + 1]++;
+    for (size_t i = 0; i < n; ++i) graph.succOffsets[i + 1] += graph.succOffsets[i];
+
+    // Fill every successor row in increasing task order
+    graph.succs.resize(graph.preds.size());
+    vector<uint32_t> next(graph.succOffsets.begin(), graph.succOffsets.end() - 1);
+    for (TaskId t = 0; t < n; ++t) {
+        for (TaskId d : graph.predecessors(t)) graph.succs[next[d]++] = t;
+    }
+}
+
+// Same for a graph with links, every successor gets the type and lag of its dependency
+template <typename Time>
+void populateSuccessors(LinkedTaskGraph<Time>& graph) {
+    populateSuccessors(static_cast<TaskGraph&>(graph));
+
+    graph.succTypes.resize(graph.preds.size());
+    graph.succLags.resize(graph.preds.size());
+    vector<uint32_t> next(graph.succOffsets.begin(), graph.succOffsets.end() - 1);
+    for (uint32_t e = 0; e < graph.preds.size(); ++e) {
+        uint32_t k = next[graph.preds[e]]++;
+        graph.succTypes[k] = graph.predTypes[e];
+        graph.succLags[k] = graph.predLags[e];
+    }
+    graph.findLinks();
+}
+
+// Number of threads to use when none is given, one per hardware thread
+unsigned defaultThreadCount() {
+    unsigned n = thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+// Runs work(0) .. work(threadCount - 1) each on its own thread and waits for all of them
+// The first exception thrown by any of them is rethrown on the calling thread
+void runOnThreads(unsigned threadCount, const function<void(unsigned)>& work) {
+    if (threadCount <= 1) {
+        work(0);
+        return;
+    }
+
+    vector<exception_ptr> errors(threadCount);
+    vector<thread> threads;
+    threads.reserve(threadCount);
+    for (unsigned t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t]() {
+            try {
+                work(t);
+            }
+            catch (...) {
+                errors[t] = current_exception();
+            }
+        });
+    }
+    for (thread& th : threads) th.join();
+    for (exception_ptr& error : errors) {
+        if (error) rethrow_exception(error);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Csv tokenizer                                                                        //
+// The only bytes the loader has to find are the ',' between columns, the ';' between  //
+// dependencies and the '\n' at the end of every row. The scanners below compare 64     //
+// bytes at a time against all three and write the offset of every hit into an index  //
+// buffer, which the row parser then walks instead of looking at every byte itself.    //
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Signature shared by all delimiter scanners
+// Writes the offset of every ',', ';' and '\n' in text into positions (which needs room for
+// size entries) and returns how many were found
+using DelimiterScanner = size_t (*)(const char* text, size_t size, uint32_t* positions);
+
+inline bool isDelimiter(char c) {
+    return c == ',' || c == ';' || c == '\n';
+}
+
+// One byte at a time, used on non-x86 cpus and for the tail of the vectorized scanners
+size_t scanDelimitersScalar(const char* text, size_t size, uint32_t* positions) {
+    size_t count = 0;
+    for (size_t i = 0; i < size; ++i) {
+        if (isDelimiter(text[i])) positions[count++] = (uint32_t)i;
+    }
+    return count;
+}
+
+#ifdef ELIXIR_X86
+inline int countTrailingZeros(uint64_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctzll(mask);
+#endif
+}
+
+// Writes the position of every set bit of the delimiter mask of the 64 bytes starting at base
+inline size_t emitDelimiterMask(uint64_t mask, size_t base, uint32_t* positions) {
+    size_t count = 0;
+    while (mask != 0) {
+        positions[count++] = (uint32_t)(base + countTrailingZeros(mask));
+        mask &= mask - 1;
+    }
+    return count;
+}
+
+// 4 x 16 bytes per step
+size_t scanDelimitersSSE2(const char* text, size_t size, uint32_t* positions) {
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i semicolon = _mm_set1_epi8(';');
+    const __m128i newline = _mm_set1_epi8('\n');
+
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        uint64_t mask = 0;
+        for (int k = 0; k < 4; ++k) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + 16 * k));
+            __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, comma), _mm_cmpeq_epi8(bytes, semicolon)),
+                                        _mm_cmpeq_epi8(bytes, newline));
+            mask |= (uint64_t)(uint32_t)_mm_movemask_epi8(hits) << (16 * k);
+        }
+        count += emitDelimiterMask(mask, i, positions + count);
+    }
+    for (; i < size; ++i) {
+        if (isDelimiter(text[i])) positions[count++] = (uint32_t)i;
+    }
+    return count;
+}
+
+// 2 x 32 bytes per step
+ELIXIR_TARGET_AVX2
+size_t scanDelimitersAVX2(const char* text, size_t size, uint32_t* positions) {
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i semicolon = _mm256_set1_epi8(';');
+    const __m256i newline = _mm256_set1_epi8('\n');
+
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        uint64_t mask = 0;
+        for (int k = 0; k < 2; ++k) {
+            __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i + 32 * k));
+            __m256i hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, comma), _mm256_cmpeq_epi8(bytes, semicolon)),
+                                           _mm256_cmpeq_epi8(bytes, newline));
+            mask |= (uint64_t)(uint32_t)_mm256_movemask_epi8(hits) << (32 * k);
+        }
+        count += emitDelimiterMask(mask, i, positions + count);
+    }
+    for (; i < size; ++i) {
+        if (isDelimiter(text[i])) positions[count++] = (uint32_t)i;
+    }
+    return count;
+}
+
+// Whether the cpu and the operating system both support AVX2
+bool cpuHasAVX2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+    __cpuidex(info, 7, 0);
+    return osSavesYmm && (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+// Picks the widest scanner the cpu supports, once
+DelimiterScanner getDelimiterScanner() {
+#ifdef ELIXIR_X86
+    static const DelimiterScanner scanner = cpuHasAVX2() ? scanDelimitersAVX2 : scanDelimitersSSE2;
+    return scanner;
+#else
+    return scanDelimitersScalar;
+#endif
+}
+
+// Problem found while validating one line of a csv
+struct CSVIssue {
+    uint64_t line; // 1 based, the header is line 1
+    string message;
+};
+
+// Thrown once a whole csv has been validated and found to have problems, carrying all of them
+struct CSVValidationError : runtime_error {
+    vector<CSVIssue> issues;
+
+    CSVValidationError(const string& filename, vector<CSVIssue> found)
+        : runtime_error(describe(filename, found)), issues(move(found))
+    {}
+
+    static string describe(const string& filename, const vector<CSVIssue>& issues) {
+        string text = to_string(issues.size()) + " problem(s) found in " + filename + ":";
+        for (const CSVIssue& issue : issues) text += "\n    line " + to_string(issue.line) + ": " + issue.message;
+        return text;
+    }
+};
+
+// Rows parsed by one thread from its part of the csv
+// Line numbers in here count from the start of the part, 0 being its first line
+template <typename Time>
+struct ParsedChunk {
+    vector<string_view> names;
+    vector<Time> durations;
+    vector<uint32_t> lines;       // Line of every row
+    vector<string_view> depNames;
+    vector<uint8_t> depTypes;     // Link of every dependency
+    vector<Time> depLags;
+    vector<uint32_t> predOffsets; // End of the dependency names of every row in depNames
+    vector<string_view> calendarNames; // Calendar of every row, when the csv has a calendar column
+    vector<uint8_t> constraintTypes;   // Constraint of every row, when the csv has a constraint column
+    vector<Time> constraintTimes;
+    vector<string_view> resourceFields; // Resources of every row, when the csv has a resources column
+    vector<CSVIssue> issues;
+    uint32_t lineCount = 0;       // Number of lines in the part, blank ones included
+};
+
+// Where the optional columns after task,duration,dependencies are, -1 for the ones the csv
+// doesn't have. They are found by their name in the header
+struct TaskColumns {
+    int calendar = -1;
+    int constraint = -1;
+    int resources = -1;
+};
+
+// Builds task rows from the delimiters found by the tokenizer
+// A ',' ends a column, a ';' ends a dependency inside the dependencies column (anywhere else
+// it is an ordinary character) and a '\n' ends the row, so the parser only ever touches the
+// bytes of the fields it keeps. Malformed rows are recorded as issues rather than thrown, and
+// kept with a duration of 0 so the rest of the file can still be checked against them
+template <typename Time>
+struct TaskRowParser {
+    const char* text;      // Start of the text the delimiter positions are relative to
+    ParsedChunk<Time>& chunk;
+
+    TaskColumns columns;
+
+    size_t fieldStart = 0; // Position of the first byte of the current field
+    int column = 0;        // 0 = task, 1 = duration, 2 = dependencies, then the optional ones
+    string_view name;
+    string_view durationField;
+    string_view calendarField;
+    string_view constraintField;
+    string_view resourceField;
+
+    TaskRowParser(const char* csvText, size_t start, ParsedChunk<Time>& output, TaskColumns optionalColumns)
+        : text(csvText), chunk(output), columns(optionalColumns), fieldStart(start)
+    {}
+
+    // Handles the delimiter at position pos
+    void delimiter(size_t pos) {
+        char c = text[pos];
+        if (c == ';' && column != 2) return;
+
+        string_view field(text + fieldStart, pos - fieldStart);
+        if (c == '\n' && !field.empty() && field.back() == '\r') field.remove_suffix(1);
+        endField(field);
+
+        if (c == ',') column++;
+        else if (c == '\n') endRow();
+        fieldStart = pos + 1;
+    }
+
+    // Handles the end of the text, which also ends the last row if it has no trailing newline
+    void finish(size_t end) {
+        if (fieldStart >= end && column == 0) return;
+        string_view field(text + fieldStart, end - fieldStart);
+        if (!field.empty() && field.back() == '\r') field.remove_suffix(1);
+        endField(field);
+        endRow();
+        fieldStart = end;
+    }
+
+    void endField(string_view field) {
+        if (column == 0) name = field;
+        else if (column == 1) durationField = field;
+        else if (column == 2 && !field.empty()) dependency(field);
+        else if (column == columns.calendar) calendarField = field;
+        else if (column == columns.constraint) constraintField = field;
+        else if (column == columns.resources) resourceField = field;
+    }
+
+    // A dependency is the name of a task, optionally followed by ':', a link type and a lag,
+    // eg. "b", "b:SS", "b:FF+2" or "b:FS-1.5". A name with a ':' that isn't followed by a link
+    // type is taken as it is
+    void dependency(string_view field) {
+        LinkType type = FinishToStart;
+        Time lag{};
+        size_t colon = field.rfind(':');
+        string_view link = colon == string_view::npos ? string_view() : field.substr(colon + 1);
+        if (link.size() >= 2 && parseLinkType(link.substr(0, 2), type)) {
+            string_view lagField = link.substr(2);
+            if (!lagField.empty() && !parseLag(lagField, lag)) {
+                issue(chunk.lineCount, "lag \"" + string(lagField) + "\" of dependency " + string(field) + " is not + or - followed by " + TimeTraits<Time>::description);
+                lag = Time();
+            }
+            field = field.substr(0, colon);
+        }
+        chunk.depNames.push_back(field);
+        chunk.depTypes.push_back(type);
+        chunk.depLags.push_back(lag);
+    }
+
+    static bool parseLinkType(string_view text, LinkType& type) {
+        if (text == "FS") type = FinishToStart;
+        else if (text == "SS") type = StartToStart;
+        else if (text == "FF") type = FinishToFinish;
+        else if (text == "SF") type = StartToFinish;
+        else return false;
+        return true;
+    }
+
+    // A constraint is its type, ':' and the time it holds the task to, eg. "SNET:5" or "MFO:12",
+    // an empty field is none
+    void constraint(uint32_t line) {
+        ConstraintType type = NoConstraint;
+        Time time{};
+        size_t colon = constraintField.find(':');
+        if (!constraintField.empty() &&
+            (colon == string_view::npos || !parseConstraintType(constraintField.substr(0, colon), type) || !TimeTraits<Time>::parse(constraintField.substr(colon + 1), time))) {
+            issue(line, "constraint \"" + string(constraintField) + "\" of task " + string(name) + " is not SNET, SNLT, FNET, FNLT, MSO or MFO followed by : and " + TimeTraits<Time>::description);
+            type = NoConstraint;
+            time = Time();
+        }
+        chunk.constraintTypes.push_back(type);
+        chunk.constraintTimes.push_back(time);
+    }
+
+    static bool parseConstraintType(string_view text, ConstraintType& type) {
+        if (text == "SNET") type = StartNoEarlier;
+        else if (text == "SNLT") type = StartNoLater;
+        else if (text == "FNET") type = FinishNoEarlier;
+        else if (text == "FNLT") type = FinishNoLater;
+        else if (text == "MSO") type = MustStartOn;
+        else if (text == "MFO") type = MustFinishOn;
+        else return false;
+        return true;
+    }
+
+    // A lag always has its sign, "+2" or "-2"
+    static bool parseLag(string_view text, Time& lag) {
+        char sign = text[0];
+        if (sign != '+' && sign != '-') return false;
+        text.remove_prefix(1);
+        if (text.empty() || text[0] == '-' || !TimeTraits<Time>::parse(text, lag)) return false;
+        if (sign == '-') lag = Time() - lag;
+        return true;
+    }
+
+    void endRow() {
+        uint32_t line = chunk.lineCount++;
+
+        // Blank lines are skipped
+        bool blank = column == 0 && name.empty();
+        bool shortRow = column == 0;
+        column = 0;
+        if (blank) return;
+
+        Time duration{};
+        if (shortRow) {
+            issue(line, "expected task,duration[,dependencies] but found only \"" + string(name) + "\"");
+        }
+        else if (name.empty()) {
+            issue(line, "task name is empty");
+        }
+        else {
+            if (!TimeTraits<Time>::parse(durationField, duration)) {
+                issue(line, "duration \"" + string(durationField) + "\" of task " + string(name) + " is not " + TimeTraits<Time>::description);
+                duration = Time();
+            }
+            else if (duration < Time()) {
+                issue(line, "duration " + string(durationField) + " of task " + string(name) + " is negative");
+                duration = Time();
+            }
+        }
+
+        // Dependencies may name tasks further down the file, so only their names are kept for now
+        if (chunk.depNames.size() > UINT32_MAX) throw runtime_error("Too many dependencies");
+        chunk.predOffsets.push_back((uint32_t)chunk.depNames.size());
+        chunk.names.push_back(name);
+        chunk.durations.push_back(duration);
+        chunk.lines.push_back(line);
+        if (columns.calendar >= 0) chunk.calendarNames.push_back(calendarField);
+        if (columns.constraint >= 0) constraint(line);
+        if (columns.resources >= 0) chunk.resourceFields.push_back(resourceField);
+
+        name = string_view();
+        durationField = string_view();
+        calendarField = string_view();
+        constraintField = string_view();
+        resourceField = string_view();
+    }
+
+    void issue(uint32_t line, string message) {
+        chunk.issues.push_back({ line, move(message) });
+    }
+};
+
+// Parses the rows in text[begin, end) into chunk, begin must be the start of a row
+template <typename Time>
+void parseCSVRange(string_view text, size_t begin, size_t end, ParsedChunk<Time>& chunk, TaskColumns columns) {
+    TaskRowParser<Time> parser(text.data(), begin, chunk, columns);
+
+    // Tokenize the text in blocks small enough to keep the index buffer in cache
+    const size_t blockSize = 1 << 16;
+    vector<uint32_t> positions(blockSize);
+    DelimiterScanner scanDelimiters = getDelimiterScanner();
+    for (size_t base = begin; base < end; base += blockSize) {
+        size_t count = scanDelimiters(text.data() + base, min(blockSize, end - base), positions.data());
+        for (size_t k = 0; k < count; ++k) parser.delimiter(base + positions[k]);
+    }
+    parser.finish(end);
+}
+
+// Function to load csv of tasks into a project with its dependency graph
+// CSV file should be formatted as
+/*
+    task,duration,dependencies
+    a,2,
+    b,3,a
+    c,2,a
+    d,5,b;c                 
+    e,4,b:SS+1;d:FF
+*/
+// A dependency is finish to start with no lag unless it says otherwise, see LinkType
+// After the dependencies a column named calendar in the header may name the calendar of every
+// task out of calendars, tasks that leave it empty work in the project calendar, one named
+// constraint may hold a task to a time, see ConstraintType, and one named resources may list
+// what the task needs out of resources as "crane;welders:2", a resource without an amount
+// needs 1 of it
+// The file is memory mapped and tokenized in place, durations are parsed straight from the
+// mapping and task names are copied out of it only once, into the symbol table
+// Finding the delimiters is left to the vectorized tokenizer above, and large files are parsed
+// by threadCount threads, each taking a range of whole rows
+// Loading doubles as validation: short rows, empty names, durations that aren't a non-negative
+// number of the time type, malformed lags and constraints, duplicate task names, dependencies on
+// unknown tasks, unknown calendars and resources a task can't get enough of are all collected
+// with their line number in the same pass, and reported together as a CSVValidationError
+template <typename Time>
+Project<Time> loadCSV(const string& filename, unsigned threadCount = defaultThreadCount(), const CalendarList& calendars = CalendarList(),
+                      const ResourceList& resources = ResourceList()) {
+    Project<Time> project;
+    TaskTable<Time>& tasks = project.tasks;
+    LinkedTaskGraph<Time>& graph = project.graph;
+    graph.predOffsets.push_back(0);
+
+    // Maps the csv file into memory, it is only needed until every name has been interned
+    MappedFile source;
+    if (!source.open(filename)) throw runtime_error("Failed to open file: " + filename);
+
+    string_view text = source.view();
+
+    // Process every line in the csv except the first line, which contains the headers
+    size_t start = text.find('\n');
+    start = start == string_view::npos ? text.size() : start + 1;
+
+    // The first three columns are fixed, the optional ones after them are found by name
+    TaskColumns columns;
+    string_view header = text.substr(0, start);
+    while (!header.empty() && (header.back() == '\n' || header.back() == '\r')) header.remove_suffix(1);
+    for (int column = 0;; ++column) {
+        size_t comma = header.find(',');
+        string_view columnName = header.substr(0, comma);
+        if (column >= 3 && columnName == "calendar") columns.calendar = column;
+        else if (column >= 3 && columnName == "constraint") columns.constraint = column;
+        else if (column >= 3 && columnName == "resources") columns.resources = column;
+        if (comma == string_view::npos) break;
+        header.remove_prefix(comma + 1);
+    }
+
+    // Split the rows into one byte range per thread, every range ends right after a newline
+    // Files under a few megabytes are not worth starting threads for
+    const size_t minChunkSize = 1 << 20;
+    size_t chunkCount = max<size_t>(1, min<size_t>(threadCount, (text.size() - start) / minChunkSize));
+    vector<size_t> bounds(chunkCount + 1, text.size());
+    bounds[0] = start;
+    for (size_t c = 1; c < chunkCount; ++c) {
+        size_t pos = max(bounds[c - 1], start + (text.size() - start) / chunkCount * c);
+        size_t newline = text.find('\n', pos);
+        bounds[c] = newline == string_view::npos ? text.size() : newline + 1;
+    }
+
+    // First phase: every thread parses its own range into its own buffers
+    vector<ParsedChunk<Time>> chunks(chunkCount);
+    runOnThreads((unsigned)chunkCount, [&](unsigned c) {
+        parseCSVRange(text, bounds[c], bounds[c + 1], chunks[c], columns);
+    });
+
+    // Merge the buffers in file order so task ids follow the rows of the csv
+    size_t taskCount = 0;
+    size_t depCount = 0;
+    for (const ParsedChunk<Time>& chunk : chunks) {
+        taskCount += chunk.names.size();
+        depCount += chunk.depNames.size();
+    }
+    if (depCount > UINT32_MAX) throw runtime_error("Too many dependencies in file: " + filename);
+
+    vector<string_view> depNames;
+    vector<string_view> calendarNames;
+    vector<string_view> resourceFields;
+    vector<uint64_t> taskLines;
+    vector<CSVIssue> issues;
+    tasks.reserve(taskCount);
+    taskLines.reserve(taskCount);
+    depNames.reserve(depCount);
+    graph.predTypes.reserve(depCount);
+    graph.predLags.reserve(depCount);
+    graph.predOffsets.reserve(taskCount + 1);
+    uint64_t firstLine = 2;
+    for (ParsedChunk<Time>& chunk : chunks) {
+        uint32_t depBase = (uint32_t)depNames.size();
+        for (uint32_t offset : chunk.predOffsets) graph.predOffsets.push_back(depBase + offset);
+        for (size_t i = 0; i < chunk.names.size(); ++i) {
+            TaskId task = tasks.add(project.names.intern(chunk.names[i]), chunk.durations[i]);
+            if (columns.constraint < 0) continue;
+            tasks.constraint[task] = chunk.constraintTypes[i];
+            tasks.constraintTime[task] = chunk.constraintTimes[i];
+        }
+        for (uint32_t line : chunk.lines) taskLines.push_back(firstLine + line);
+        for (CSVIssue& issue : chunk.issues) issues.push_back({ firstLine + issue.line, move(issue.message) });
+        depNames.insert(depNames.end(), chunk.depNames.begin(), chunk.depNames.end());
+        calendarNames.insert(calendarNames.end(), chunk.calendarNames.begin(), chunk.calendarNames.end());
+        resourceFields.insert(resourceFields.end(), chunk.resourceFields.begin(), chunk.resourceFields.end());
+        graph.predTypes.insert(graph.predTypes.end(), chunk.depTypes.begin(), chunk.depTypes.end());
+        graph.predLags.insert(graph.predLags.end(), chunk.depLags.begin(), chunk.depLags.end());
+        firstLine += chunk.lineCount;
+        chunk = ParsedChunk<Time>();
+    }
+
+    // Every name must belong to one task only
+    indexTasksByName(project);
+    for (TaskId i = 0; i < tasks.size(); ++i) {
+        TaskId first = project.taskByName[tasks.name[i]];
+        if (first != i && !project.names.name(tasks.name[i]).empty()) {
+            issues.push_back({ taskLines[i], "task " + string(project.names.name(tasks.name[i])) + " is already defined on line " + to_string(taskLines[first]) });
+        }
+    }
+
+    // The calendar names go through a symbol table of their own, ids match their position
+    tasks.calendars = calendars.calendars;
+    if (!calendarNames.empty()) {
+        SymbolTable calendarIds;
+        for (const string& calendarName : calendars.names) calendarIds.intern(calendarName);
+        for (TaskId i = 0; i < tasks.size(); ++i) {
+            if (calendarNames[i].empty()) continue;
+            NameId id = calendarIds.find(calendarNames[i]);
+            if (id != noName) tasks.calendar[i] = (CalendarId)id;
+            else issues.push_back({ taskLines[i], "task " + string(project.names.name(tasks.name[i])) + " works in unknown calendar " + string(calendarNames[i]) });
+        }
+    }
+
+    // So do the resource names, the demands of every task go to the end of tasks.demands
+    tasks.capacities = resources.capacities;
+    if (!resourceFields.empty()) {
+        SymbolTable resourceIds;
+        for (const string& resourceName : resources.names) resourceIds.intern(resourceName);
+        for (TaskId i = 0; i < tasks.size(); ++i) {
+            string_view taskName = project.names.name(tasks.name[i]);
+            tasks.firstDemand[i] = (uint32_t)tasks.demands.size();
+            for (string_view field = resourceFields[i]; !field.empty();) {
+                size_t semicolon = field.find(';');
+                string_view entry = field.substr(0, semicolon);
+                field = semicolon == string_view::npos ? string_view() : field.substr(semicolon + 1);
+                if (entry.empty()) continue;
+
+                // A resource is its name, optionally followed by ':' and the amount
+                size_t colon = entry.find(':');
+                string_view resourceName = entry.substr(0, colon);
+                uint32_t amount = 1;
+                if (colon != string_view::npos && (!IntegerTimeTraits<uint32_t>::parse(entry.substr(colon + 1), amount) || amount == 0)) {
+                    issues.push_back({ taskLines[i], "resource \"" + string(entry) + "\" of task " + string(taskName) + " is not a resource optionally followed by : and a positive whole number" });
+                    continue;
+                }
+                NameId id = resourceIds.find(resourceName);
+                if (id == noName) {
+                    issues.push_back({ taskLines[i], "task " + string(taskName) + " needs unknown resource " + string(resourceName) });
+                    continue;
+                }
+                auto taken = find_if(tasks.demands.begin() + tasks.firstDemand[i], tasks.demands.end(), [&](const ResourceDemand& demand) { return demand.resource == id; });
+                if (taken != tasks.demands.end()) issues.push_back({ taskLines[i], "task " + string(taskName) + " needs resource " + string(resourceName) + " twice" });
+                else if (amount > resources.capacities[id]) {
+                    issues.push_back({ taskLines[i], "task " + string(taskName) + " needs " + to_string(amount) + " of resource " + string(resourceName) + " which only has " + to_string(resources.capacities[id]) });
+                }
+                else tasks.demands.push_back({ (ResourceId)id, amount });
+            }
+            tasks.demandCount[i] = (uint16_t)(tasks.demands.size() - tasks.firstDemand[i]);
+        }
+        if (tasks.demands.size() > UINT32_MAX) throw runtime_error("Too many resource demands in file: " + filename);
+    }
+
+    // Second phase: every task is known now, resolve the dependency names to task ids in parallel
+    // The symbol table is only read from here on, so the threads can share it
+    // Unknown dependencies are collected by every thread on its own and merged afterwards
+    graph.preds.resize(depNames.size());
+    unsigned resolveThreads = (unsigned)max<size_t>(1, min<size_t>(threadCount, depNames.size() / (1 << 16)));
+    vector<vector<CSVIssue>> resolveIssues(resolveThreads);
+    runOnThreads(resolveThreads, [&](unsigned t) {
+        size_t first = depNames.size() * t / resolveThreads;
+        size_t last = depNames.size() * (t + 1) / resolveThreads;
+        for (size_t i = first; i < last; ++i) {
+            NameId id = project.names.find(depNames[i]);
+            graph.preds[i] = id == noName ? noTask : project.taskByName[id];
+            if (graph.preds[i] != noTask) continue;
+
+            // The row owning dependency i is the first one whose dependencies end after it
+            size_t row = upper_bound(graph.predOffsets.begin(), graph.predOffsets.end(), (uint32_t)i) - graph.predOffsets.begin() - 1;
+            resolveIssues[t].push_back({ taskLines[row], "task " + string(project.names.name(tasks.name[row])) + " depends on unknown task " + string(depNames[i]) });
+        }
+    });
+    for (vector<CSVIssue>& found : resolveIssues) {
+        for (CSVIssue& issue : found) issues.push_back(move(issue));
+    }
+
+    if (!issues.empty()) {
+        stable_sort(issues.begin(), issues.end(), [](const CSVIssue& a, const CSVIssue& b) { return a.line < b.line; });
+        throw CSVValidationError(filename, move(issues));
+    }
+    populateSuccessors(graph);
+    tasks.findConstraints();
+
+    return project;
+}
+
+// Function to load the calendars of a csv, formatted as
+/*
+    calendar,week,holidays
+    office,1111100,10;24-26
+    site,1111110,
+*/
+// week has a 1 for every working unit of a week of 7 units, the first being the weekday of
+// time 0, and holidays lists the units (or first-last ranges of units) that aren't worked
+// The first calendar is the project calendar. Problems are reported together as a
+// CSVValidationError, like those of the task csv
+CalendarList loadCalendarCSV(const string& filename) {
+    ifstream file(filename);
+    if (!file.is_open()) throw runtime_error("Failed to open file: " + filename);
+
+    CalendarList list;
+    vector<CSVIssue> issues;
+    string text;
+    getline(file, text);
+    for (uint64_t line = 2; getline(file, text); ++line) {
+        if (!text.empty() && text.back() == '\r') text.pop_back();
+        if (text.empty()) continue;
+
+        string_view row = text;
+        size_t first = row.find(',');
+        size_t second = first == string_view::npos ? first : row.find(',', first + 1);
+        if (second == string_view::npos) {
+            issues.push_back({ line, "expected calendar,week,holidays but found \"" + text + "\"" });
+            continue;
+        }
+        string name(row.substr(0, first));
+        string_view week = row.substr(first + 1, second - first - 1);
+        string_view holidays = row.substr(second + 1);
+        if (name.empty()) issues.push_back({ line, "calendar name is empty" });
+        else if (find(list.names.begin(), list.names.end(), name) != list.names.end()) issues.push_back({ line, "calendar " + name + " is already defined" });
+
+        uint8_t workWeek = 0;
+        bool valid = week.size() == 7;
+        for (size_t d = 0; valid && d < 7; ++d) {
+            if (week[d] == '1') workWeek |= (uint8_t)(1 << d);
+            else if (week[d] != '0') valid = false;
+        }
+        if (!valid || workWeek == 0) {
+            issues.push_back({ line, "week \"" + string(week) + "\" of calendar " + name + " is not 7 of 0 and 1 with at least one 1" });
+            workWeek = 1;
+        }
+
+        vector<int64_t> days;
+        while (!holidays.empty()) {
+            size_t semicolon = holidays.find(';');
+            string_view entry = holidays.substr(0, semicolon);
+            holidays = semicolon == string_view::npos ? string_view() : holidays.substr(semicolon + 1);
+            if (entry.empty()) continue;
+
+            size_t dash = entry.find('-');
+            string_view firstDay = entry.substr(0, dash);
+            string_view lastDay = dash == string_view::npos ? firstDay : entry.substr(dash + 1);
+            int64_t from = -1;
+            int64_t to = -1;
+            if (!TimeTraits<int64_t>::parse(firstDay, from) || !TimeTraits<int64_t>::parse(lastDay, to) || from < 0 || from > to || to > WorkCalendar::maxHoliday) {
+                issues.push_back({ line, "holiday \"" + string(entry) + "\" of calendar " + name + " is not a time unit or range of them in [0, " + to_string(WorkCalendar::maxHoliday) + "]" });
+                continue;
+            }
+            for (int64_t day = from; day <= to; ++day) days.push_back(day);
+        }
+
+        list.names.push_back(name);
+        list.calendars.emplace_back(workWeek, move(days));
+    }
+
+    if (list.calendars.size() > numeric_limits<CalendarId>::max()) issues.push_back({ 1, "more than " + to_string(numeric_limits<CalendarId>::max()) + " calendars" });
+    if (!issues.empty()) throw CSVValidationError(filename, move(issues));
+    if (list.calendars.empty()) throw runtime_error("No calendars in " + filename);
+    return list;
+}
+
+// Function to load the resources of a csv, formatted as
+/*
+    resource,capacity
+    crane,1
+    welders,4
+*/
+// capacity is how many units of the resource there are, which the tasks running at any one time
+// can't need more of together. Problems are reported together as a CSVValidationError
+ResourceList loadResourceCSV(const string& filename) {
+    ifstream file(filename);
+    if (!file.is_open()) throw runtime_error("Failed to open file: " + filename);
+
+    ResourceList list;
+    vector<CSVIssue> issues;
+    string text;
+    getline(file, text);
+    for (uint64_t line = 2; getline(file, text); ++line) {
+        if (!text.empty() && text.back() == '\r') text.pop_back();
+        if (text.empty()) continue;
+
+        string_view row = text;
+        size_t comma = row.find(',');
+        if (comma == string_view::npos) {
+            issues.push_back({ line, "expected resource,capacity but found \"" + text + "\"" });
+            continue;
+        }
+        string name(row.substr(0, comma));
+        string_view capacityField = row.substr(comma + 1);
+        if (name.empty()) issues.push_back({ line, "resource name is empty" });
+        else if (find(list.names.begin(), list.names.end(), name) != list.names.end()) issues.push_back({ line, "resource " + name + " is already defined" });
+
+        uint32_t capacity = 0;
+        if (!IntegerTimeTraits<uint32_t>::parse(capacityField, capacity) || capacity == 0) {
+            issues.push_back({ line, "capacity \"" + string(capacityField) + "\" of resource " + name + " is not a positive whole number" });
+        }
+
+        list.names.push_back(name);
+        list.capacities.push_back(capacity);
+    }
+
+    if (list.capacities.size() > numeric_limits<ResourceId>::max()) issues.push_back({ 1, "more than " + to_string(numeric_limits<ResourceId>::max()) + " resources" });
+    if (!issues.empty()) throw CSVValidationError(filename, move(issues));
+    if (list.capacities.empty()) throw runtime_error("No resources in " + filename);
+    return list;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Compiled project files                                                               //
+// A compiled project is the loaded project written out as it sits in memory, so that  //
+// loading it again is a memory mapping plus a few copies instead of parsing text and  //
+// resolving names. Only the successors aren't stored, they are rebuilt from the       //
+// dependencies on loading so the two can never disagree. The file is laid out as      //
+//     header                                                                           //
+//     name offsets    uint64_t[nameCount + 1], name i is names[offset i, offset i + 1) //
+//     names           char[nameBytes], every distinct name back to back                //
+//     name slots      uint32_t[slotCount], the hash table of the symbol table          //
+//     task names      uint32_t[taskCount], name id of every task                       //
+//     durations       Time[taskCount], in the time type the header names               //
+//     pred offsets    uint32_t[taskCount + 1]                                          //
+//     preds           uint32_t[edgeCount]                                              //
+//     pred types      uint8_t[edgeCount], the LinkType of every dependency             //
+//     pred lags       Time[edgeCount]                                                  //
+//     task calendars  uint16_t[taskCount], CalendarId of every task                    //
+//     calendar weeks  uint8_t[calendarCount], the working week of every calendar       //
+//     holiday offsets uint64_t[calendarCount + 1], as the name offsets                 //
+//     holidays        int64_t[holidayCount]                                            //
+//     constraints     uint8_t[taskCount], the ConstraintType of every task             //
+//     constraint time Time[taskCount], the time of every constraint                    //
+//     first demands   uint32_t[taskCount], where the demands of every task start       //
+//     demand counts   uint16_t[taskCount]                                              //
+//     demand resource uint16_t[demandCount], ResourceId of every demand                //
+//     demand amounts  uint32_t[demandCount]                                            //
+//     capacities      uint32_t[resourceCount]                                          //
+// with every section starting on an 8 byte boundary. Numbers are stored in the byte   //
+// order of the machine that wrote the file, which the header records.                //
+//////////////////////////////////////////////////////////////////////////////////////////
+
+const char projectFileMagic[8] = { 'E', 'L', 'X', 'P', 'R', 'J', '\0', '\0' };
+const uint32_t projectFileVersion = 8;
+const uint32_t projectFileByteOrder = 0x01020304;
+
+struct ProjectFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t timeType;  // TimeTraits<Time>::id
+    uint32_t reserved;
+    uint64_t taskCount;
+    uint64_t edgeCount;
+    uint64_t nameCount;
+    uint64_t nameBytes;
+    uint64_t slotCount;
+    uint64_t calendarCount;
+    uint64_t holidayCount;
+    uint64_t resourceCount;
+    uint64_t demandCount;
+};
+
+// Rounds a section size up to the 8 byte alignment of the next section
+inline uint64_t alignSection(uint64_t size) {
+    return (size + 7) & ~(uint64_t)7;
+}
+
+// Whether the file starts like a compiled project file
+bool isProjectFile(const string& filename) {
+    ifstream file(filename, ios::binary);
+    char magic[sizeof(projectFileMagic)] = {};
+    file.read(magic, sizeof(magic));
+    return file && memcmp(magic, projectFileMagic, sizeof(magic)) == 0;
+}
+
+// Returns the time type id a project file was compiled with, or 0 if it isn't a project file
+uint32_t readProjectTimeType(const string& filename) {
+    ifstream file(filename, ios::binary);
+    ProjectFileHeader header = {};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || memcmp(header.magic, projectFileMagic, sizeof(header.magic)) != 0) return 0;
+    return header.timeType;
+}
+
+// Writes one section of a compiled project file followed by the padding up to the next section
+template <typename T>
+void writeSection(ofstream& file, const T* data, size_t count) {
+    static const char padding[8] = {};
+    uint64_t bytes = (uint64_t)count * sizeof(T);
+    if (bytes > 0) file.write(reinterpret_cast<const char*>(data), bytes);
+    file.write(padding, alignSection(bytes) - bytes);
+}
+
+// Compiles a loaded project into a project file, returns false after printing why if it can't
+template <typename Time>
+bool writeProjectFile(const Project<Time>& project, const string& filename) {
+    ofstream file(filename, ios::binary);
+    if (!file.is_open()) {
+        cerr << "Failed to open file for writing: " << filename << endl;
+        return false;
+    }
+
+    const TaskTable<Time>& tasks = project.tasks;
+    const LinkedTaskGraph<Time>& graph = project.graph;
+    const SymbolTable& symbols = project.names;
+
+    // Lay out the name table
+    vector<uint64_t> nameOffsets(symbols.size() + 1, 0);
+    for (NameId id = 0; id < symbols.size(); ++id) nameOffsets[id + 1] = nameOffsets[id] + symbols.name(id).size();
+    string names;
+    names.reserve(nameOffsets.back());
+    for (NameId id = 0; id < symbols.size(); ++id) names.append(symbols.name(id));
+
+    ProjectFileHeader header = {};
+    memcpy(header.magic, projectFileMagic, sizeof(header.magic));
+    header.version = projectFileVersion;
+    header.byteOrder = projectFileByteOrder;
+    header.timeType = TimeTraits<Time>::id;
+    header.taskCount = tasks.size();
+    header.edgeCount = graph.preds.size();
+    header.nameCount = symbols.size();
+    header.nameBytes = names.size();
+    header.slotCount = symbols.hashSlots().size();
+
+    // Calendars are stored as they were read, the tables are rebuilt on loading
+    vector<uint8_t> calendarWeeks;
+    vector<uint64_t> holidayOffsets(1, 0);
+    vector<int64_t> holidays;
+    for (const WorkCalendar& calendar : tasks.calendars) {
+        calendarWeeks.push_back(calendar.workWeek());
+        holidays.insert(holidays.end(), calendar.holidayList().begin(), calendar.holidayList().end());
+        holidayOffsets.push_back(holidays.size());
+    }
+    header.calendarCount = calendarWeeks.size();
+    header.holidayCount = holidays.size();
+
+    // Demands are split into one section per field, so that no padding ends up in the file
+    vector<uint16_t> demandResources;
+    vector<uint32_t> demandAmounts;
+    for (const ResourceDemand& demand : tasks.demands) {
+        demandResources.push_back(demand.resource);
+        demandAmounts.push_back(demand.amount);
+    }
+    header.resourceCount = tasks.capacities.size();
+    header.demandCount = tasks.demands.size();
+
+    // An empty project has no offset arrays in memory, but the file always has them
+    vector<uint32_t> noEdges(tasks.size() + 1, 0);
+    const vector<uint32_t>& predOffsets = graph.size() == tasks.size() ? graph.predOffsets : noEdges;
+
+    writeSection(file, &header, 1);
+    writeSection(file, nameOffsets.data(), nameOffsets.size());
+    writeSection(file, names.data(), names.size());
+    writeSection(file, symbols.hashSlots().data(), symbols.hashSlots().size());
+    writeSection(file, tasks.name.data(), tasks.size());
+    writeSection(file, tasks.duration.data(), tasks.size());
+    writeSection(file, predOffsets.data(), predOffsets.size());
+    writeSection(file, graph.preds.data(), graph.preds.size());
+    writeSection(file, graph.predTypes.data(), graph.predTypes.size());
+    writeSection(file, graph.predLags.data(), graph.predLags.size());
+    writeSection(file, tasks.calendar.data(), tasks.size());
+    writeSection(file, calendarWeeks.data(), calendarWeeks.size());
+    writeSection(file, holidayOffsets.data(), holidayOffsets.size());
+    writeSection(file, holidays.data(), holidays.size());
+    writeSection(file, tasks.constraint.data(), tasks.size());
+    writeSection(file, tasks.constraintTime.data(), tasks.size());
+    writeSection(file, tasks.firstDemand.data(), tasks.size());
+    writeSection(file, tasks.demandCount.data(), tasks.size());
+    writeSection(file, demandResources.data(), demandResources.size());
+    writeSection(file, demandAmounts.data(), demandAmounts.size());
+    writeSection(file, tasks.capacities.data(), tasks.capacities.size());
+
+    file.close();
+    if (!file) {
+        cerr << "Failed to write file: " << filename << endl;
+        return false;
+    }
+    cout << "Compiled project written to " << filename << endl;
+    return true;
+}
+
+// Loads a compiled project file
+// The arrays, the name table and even the hash table of the symbol table are copied straight
+// out of the mapped file, nothing is parsed. The successors are the one thing rebuilt, with the
+// same counting sort the csv loader uses, and the hash table is checked by looking up every name
+template <typename Time>
+Project<Time> loadProjectFile(const string& filename) {
+    Project<Time> project;
+    LinkedTaskGraph<Time>& graph = project.graph;
+    graph.predOffsets.push_back(0);
+
+    MappedFile source;
+    if (!source.open(filename)) throw runtime_error("Failed to open file: " + filename);
+
+    const char* data = source.data();
+    uint64_t size = source.size();
+    auto corrupt = [&](const string& reason) {
+        return runtime_error("Corrupt project file " + filename + ": " + reason);
+    };
+
+    if (size < sizeof(ProjectFileHeader)) throw corrupt("truncated header");
+    ProjectFileHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, projectFileMagic, sizeof(header.magic)) != 0) throw corrupt("not a project file");
+    if (header.byteOrder != projectFileByteOrder) throw corrupt("written on a machine with another byte order");
+    if (header.version != projectFileVersion) throw corrupt("unsupported version " + to_string(header.version));
+    if (header.timeType != TimeTraits<Time>::id) {
+        string compiledType = "an unknown";
+        visitTimeType("", header.timeType, [&](auto zero) { compiledType = TimeTraits<decltype(zero)>::name; });
+        throw runtime_error("Project file " + filename + " was compiled with the " + compiledType + " time type, not " + TimeTraits<Time>::name);
+    }
+    if (header.taskCount > UINT32_MAX || header.edgeCount > UINT32_MAX || header.nameCount >= noName) throw corrupt("too many tasks or dependencies");
+    if ((header.slotCount & (header.slotCount - 1)) != 0 || header.slotCount < header.nameCount * 2) throw corrupt("bad name hash table");
+
+    // Locate every section and make sure the file is long enough to hold all of them
+    uint64_t n = header.taskCount;
+    uint64_t m = header.edgeCount;
+    uint64_t offset = alignSection(sizeof(ProjectFileHeader));
+    auto section = [&](uint64_t bytes) {
+        uint64_t start = offset;
+        offset += alignSection(bytes);
+        if (offset > size) throw corrupt("truncated");
+        return data + start;
+    };
+    const uint64_t* nameOffsets = reinterpret_cast<const uint64_t*>(section((header.nameCount + 1) * sizeof(uint64_t)));
+    const char* names = section(header.nameBytes);
+    const NameId* slots = reinterpret_cast<const NameId*>(section(header.slotCount * sizeof(NameId)));
+    const NameId* taskNames = reinterpret_cast<const NameId*>(section(n * sizeof(NameId)));
+    const Time* durations = reinterpret_cast<const Time*>(section(n * sizeof(Time)));
+    const uint32_t* predOffsets = reinterpret_cast<const uint32_t*>(section((n + 1) * sizeof(uint32_t)));
+    const uint32_t* preds = reinterpret_cast<const uint32_t*>(section(m * sizeof(uint32_t)));
+    const uint8_t* predTypes = reinterpret_cast<const uint8_t*>(section(m * sizeof(uint8_t)));
+    const Time* predLags = reinterpret_cast<const Time*>(section(m * sizeof(Time)));
+    if (header.calendarCount > numeric_limits<CalendarId>::max() || header.holidayCount > UINT32_MAX) throw corrupt("too many calendars or holidays");
+    const CalendarId* taskCalendars = reinterpret_cast<const CalendarId*>(section(n * sizeof(CalendarId)));
+    const uint8_t* calendarWeeks = reinterpret_cast<const uint8_t*>(section(header.calendarCount * sizeof(uint8_t)));
+    const uint64_t* holidayOffsets = reinterpret_cast<const uint64_t*>(section((header.calendarCount + 1) * sizeof(uint64_t)));
+    const int64_t* holidays = reinterpret_cast<const int64_t*>(section(header.holidayCount * sizeof(int64_t)));
+    const uint8_t* constraints = reinterpret_cast<const uint8_t*>(section(n * sizeof(uint8_t)));
+    const Time* constraintTimes = reinterpret_cast<const Time*>(section(n * sizeof(Time)));
+    if (header.resourceCount > numeric_limits<ResourceId>::max() || header.demandCount > UINT32_MAX) throw corrupt("too many resources or demands");
+    const uint32_t* firstDemands = reinterpret_cast<const uint32_t*>(section(n * sizeof(uint32_t)));
+    const uint16_t* demandCounts = reinterpret_cast<const uint16_t*>(section(n * sizeof(uint16_t)));
+    const ResourceId* demandResources = reinterpret_cast<const ResourceId*>(section(header.demandCount * sizeof(ResourceId)));
+    const uint32_t* demandAmounts = reinterpret_cast<const uint32_t*>(section(header.demandCount * sizeof(uint32_t)));
+    const uint32_t* capacities = reinterpret_cast<const uint32_t*>(section(header.resourceCount * sizeof(uint32_t)));
+
+    if (nameOffsets[header.nameCount] != header.nameBytes || predOffsets[n] != m || holidayOffsets[header.calendarCount] != header.holidayCount) throw corrupt("inconsistent sections");
+    for (uint64_t id = 0; id < header.nameCount; ++id) {
+        if (nameOffsets[id] > nameOffsets[id + 1]) throw corrupt("inconsistent name table");
+    }
+    for (uint64_t slot = 0; slot < header.slotCount; ++slot) {
+        if (slots[slot] != noName && slots[slot] >= header.nameCount) throw corrupt("bad name hash table");
+    }
+    project.names.load(names, nameOffsets, header.nameCount, slots, header.slotCount);
+    if (!project.names.consistent()) throw corrupt("bad name hash table");
+
+    // Tasks
+    project.tasks.reserve(n);
+    for (uint64_t i = 0; i < n; ++i) {
+        if (taskNames[i] >= header.nameCount) throw corrupt("task with an unknown name");
+        if (!(durations[i] >= Time())) throw corrupt("negative duration");
+        if (taskCalendars[i] >= max<uint64_t>(header.calendarCount, 1)) throw corrupt("task in an unknown calendar");
+        if (constraints[i] > MustFinishOn) throw corrupt("unknown constraint");
+        project.tasks.add(taskNames[i], durations[i]);
+        project.tasks.calendar[i] = taskCalendars[i];
+        project.tasks.constraint[i] = constraints[i];
+        project.tasks.constraintTime[i] = constraintTimes[i];
+        if ((uint64_t)firstDemands[i] + demandCounts[i] > header.demandCount) throw corrupt("demands out of range");
+        project.tasks.firstDemand[i] = firstDemands[i];
+        project.tasks.demandCount[i] = demandCounts[i];
+    }
+    project.tasks.findConstraints();
+
+    // Resources
+    project.tasks.capacities.assign(capacities, capacities + header.resourceCount);
+    for (uint64_t d = 0; d < header.demandCount; ++d) {
+        if (demandResources[d] >= header.resourceCount || demandAmounts[d] == 0 || demandAmounts[d] > capacities[demandResources[d]]) throw corrupt("bad resource demand");
+        project.tasks.demands.push_back({ demandResources[d], demandAmounts[d] });
+    }
+    indexTasksByName(project);
+
+    // Calendars
+    for (uint64_t c = 0; c < header.calendarCount; ++c) {
+        if (holidayOffsets[c] > holidayOffsets[c + 1] || calendarWeeks[c] == 0 || calendarWeeks[c] > 0x7F) throw corrupt("bad calendar");
+        vector<int64_t> days(holidays + holidayOffsets[c], holidays + holidayOffsets[c + 1]);
+        for (int64_t day : days) {
+            if (day < 0 || day > WorkCalendar::maxHoliday) throw corrupt("bad calendar");
+        }
+        project.tasks.calendars.emplace_back(calendarWeeks[c], move(days));
+    }
+
+    // The dependency arrays are already in their in-memory layout
+    graph.predOffsets.assign(predOffsets, predOffsets + n + 1);
+    graph.preds.assign(preds, preds + m);
+    graph.predTypes.assign(predTypes, predTypes + m);
+    graph.predLags.assign(predLags, predLags + m);
+    for (uint64_t i = 0; i < n; ++i) {
+        if (predOffsets[i] > predOffsets[i + 1]) throw corrupt("inconsistent graph offsets");
+    }
+    for (uint64_t e = 0; e < m; ++e) {
+        if (preds[e] >= n) throw corrupt("dependency on an unknown task");
+        if (predTypes[e] > StartToFinish) throw corrupt("unknown link type");
+    }
+    populateSuccessors(graph);
+
+    return project;
+}
+
+// Loads either a compiled project file or a csv, whichever the file is
+template <typename Time>
+Project<Time> loadProject(const string& filename, unsigned threadCount = defaultThreadCount(), const CalendarList& calendars = CalendarList(),
+                          const ResourceList& resources = ResourceList()) {
+    if (isProjectFile(filename)) return loadProjectFile<Time>(filename);
+    return loadCSV<Time>(filename, threadCount, calendars, resources);
+}
+
+// Debug printing for tasklist
+template <typename Time>
+void debugPrint(const Project<Time>& project){
+    for (TaskId i = 0; i < project.tasks.size(); ++i) {
+        cout << "Task: " << project.names.name(project.tasks.name[i]) << ", Duration: " << showTime(project.tasks.duration[i]) << ", Dependencies: ";
+        for (TaskId d : project.graph.predecessors(i)) cout << project.names.name(project.tasks.name[d]) << "; ";
+        cout << endl;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Cycle detection                                                                      //
+// A task that (indirectly) depends on itself can never be scheduled, so the graph is   //
+// checked before the passes. Tarjan's algorithm finds the strongly connected           //
+// components in one linear sweep, and every component with more than one task (or a    //
+// task that depends on itself) holds at least one cycle, which is then traced out      //
+// explicitly so it can be reported by name.                                            //
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Finds one cycle in every strongly connected component that has one
+// Each cycle is returned as the list of tasks along it, where every task is a dependency of
+// the next one and the last task is a dependency of the first
+vector<vector<TaskId>> findDependencyCycles(const TaskGraph& graph) {
+    const uint32_t unvisited = UINT32_MAX;
+    size_t n = graph.size();
+
+    // Tarjan's algorithm with the recursion turned into an explicit stack of (task, next edge)
+    vector<uint32_t> index(n, unvisited);
+    vector<uint32_t> low(n);
+    vector<uint32_t> component(n, unvisited);
+    vector<TaskId> sccStack;
+    vector<pair<TaskId, uint32_t>> callStack;
+    vector<TaskId> cyclicRoots; // One task of every component that contains a cycle
+    uint32_t nextIndex = 0;
+    uint32_t componentCount = 0;
+
+    for (TaskId root = 0; root < n; ++root) {
+        if (index[root] != unvisited) continue;
+        index[root] = low[root] = nextIndex++;
+        sccStack.push_back(root);
+        callStack.push_back({ root, graph.succOffsets[root] });
+
+        while (!callStack.empty()) {
+            TaskId v = callStack.back().first;
+            uint32_t& edge = callStack.back().second;
+
+            // Visit the next successor of v
+            if (edge < graph.succOffsets[v + 1]) {
+                TaskId w = graph.succs[edge++];
+                if (index[w] == unvisited) {
+                    index[w] = low[w] = nextIndex++;
+                    sccStack.push_back(w);
+                    callStack.push_back({ w, graph.succOffsets[w] });
+                }
+                else if (component[w] == unvisited) {
+                    // w is still on the component stack
+                    low[v] = min(low[v], index[w]);
+                }
+                continue;
+            }
+
+            // Every successor of v is done, v is the root of a component if nothing reached above it
+            callStack.pop_back();
+            if (!callStack.empty()) {
+                TaskId parent = callStack.back().first;
+                low[parent] = min(low[parent], low[v]);
+            }
+            if (low[v] != index[v]) continue;
+
+            size_t size = 0;
+            TaskId w;
+            do {
+                w = sccStack.back();
+                sccStack.pop_back();
+                component[w] = componentCount;
+                size++;
+            } while (w != v);
+            componentCount++;
+
+            bool selfDependent = false;
+            for (TaskId s : graph.successors(v)) selfDependent = selfDependent || s == v;
+            if (size > 1 || selfDependent) cyclicRoots.push_back(v);
+        }
+    }
+
+    // Trace a shortest cycle through the root of every cyclic component with a breadth first
+    // search that stays inside the component, until an edge leads back to the root
+    vector<vector<TaskId>> cycles;
+    vector<TaskId> parent(n, noTask);
+    vector<TaskId> queue;
+    for (TaskId root : cyclicRoots) {
+        queue.assign(1, root);
+        TaskId last = noTask;
+        for (size_t head = 0; head < queue.size() && last == noTask; ++head) {
+            TaskId v = queue[head];
+            for (TaskId w : graph.successors(v)) {
+                if (w == root) {
+                    last = v;
+                    break;
+                }
+                if (component[w] == component[root] && parent[w] == noTask) {
+                    parent[w] = v;
+                    queue.push_back(w);
+                }
+            }
+        }
+
+        vector<TaskId> cycle;
+        for (TaskId v = last; v != root; v = parent[v]) cycle.push_back(v);
+        cycle.push_back(root);
+        reverse(cycle.begin(), cycle.end());
+        cycles.push_back(cycle);
+    }
+    return cycles;
+}
+
+// Prints every cycle as a chain of task names, eg. "a -> b -> c -> a"
+template <typename Time>
+void printDependencyCycles(const Project<Time>& project, const vector<vector<TaskId>>& cycles) {
+    cerr << "Found " << cycles.size() << " dependency cycle(s), every task below depends on the one before it:" << endl;
+    for (const vector<TaskId>& cycle : cycles) {
+        cerr << "    ";
+        for (TaskId t : cycle) cerr << project.names.name(project.tasks.name[t]) << " -> ";
+        cerr << project.names.name(project.tasks.name[cycle.front()]) << endl;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Transitive reduction                                                                 //
+// When c depends on b and b depends on a, c listing a as well adds nothing: b already  //
+// can't start before a is done. Such implied dependencies (and repeated ones) can be   //
+// dropped without changing a single time in the schedule, since durations are never    //
+// negative. A dependency of a task is implied exactly when it is an ancestor of        //
+// another of the task's dependencies, so every task walks up from its dependencies and //
+// drops the ones it runs into. Proving that a dependency is *not* implied would take a //
+// walk through all of its task's ancestors, so the walk is pruned with interval        //
+// labels: number the tasks in post-order of a depth-first search up the dependencies   //
+// and give every task the lowest number among its ancestors as well. A task's          //
+// ancestors then have both numbers inside its own interval, and the walk never enters  //
+// a task whose interval holds none of the dependencies still being looked for. Where   //
+// the intervals can't tell, a walk could still go through most of the plan, so it      //
+// gives up after maxWalk tasks and keeps whatever it hasn't found. That only leaves a  //
+// few implied dependencies in, the schedule is the same either way. The tasks are      //
+// independent of each other and are shared out between threads.                        //
+// With typed links only finish to start ones take part. Chains of them with no lead    //
+// are what implies a dependency, and only an FS link with no lag (or a lead) can be    //
+// implied, anything else asks for more than the chain guarantees and is kept.          //
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Numbers the tasks in post-order of a depth-first search up the dependencies, started from
+// every task nothing depends on, and finds the lowest number among the ancestors of each task
+// Only the dependencies e with follow[e] set count. reversed searches the tasks and their
+// dependencies back to front, which gives different intervals to prune with
+// The graph must be acyclic
+void getAncestorIntervals(const TaskGraph& graph, const vector<uint8_t>& follow, bool reversed, vector<uint32_t>& post, vector<uint32_t>& low) {
+    size_t n = graph.size();
+    post.assign(n, UINT32_MAX);
+    low.assign(n, UINT32_MAX);
+    vector<uint8_t> followed(n, 0);
+    for (uint32_t e = 0; e < graph.preds.size(); ++e) {
+        if (follow[e]) followed[graph.preds[e]] = 1;
+    }
+
+    // Every task on the stack with how many of its dependencies have been looked at
+    vector<pair<TaskId, uint32_t>> stack;
+    uint32_t next = 0;
+    for (size_t k = 0; k < n; ++k) {
+        TaskId root = (TaskId)(reversed ? n - 1 - k : k);
+        if (followed[root]) continue;
+        stack.push_back({ root, 0 });
+        while (!stack.empty()) {
+            auto& [i, seen] = stack.back();
+            uint32_t first = graph.predOffsets[i];
+            uint32_t count = graph.predOffsets[i + 1] - first;
+            if (seen < count) {
+                uint32_t e = first + (reversed ? count - 1 - seen : seen);
+                ++seen;
+                if (follow[e] && post[graph.preds[e]] == UINT32_MAX) stack.push_back({ graph.preds[e], 0 });
+                continue;
+            }
+            // A dependency is never still on the stack, so all of them are numbered by now
+            post[i] = next++;
+            low[i] = post[i];
+            for (uint32_t e = first; e < first + count; ++e) {
+                if (follow[e]) low[i] = min(low[i], low[graph.preds[e]]);
+            }
+            stack.pop_back();
+        }
+    }
+}
+
+// Removes the implied and repeated dependencies from the graph and returns how many there were
+// order must be a topological order of the graph
+template <typename Time>
+size_t removeImpliedDependencies(LinkedTaskGraph<Time>& graph, const vector<TaskId>& order, unsigned threadCount = defaultThreadCount()) {
+    const size_t maxWalk = 1 << 10;
+    size_t n = graph.size();
+    vector<uint32_t> rank(n);
+    for (uint32_t r = 0; r < n; ++r) rank[order[r]] = r;
+
+    // Which links the walks follow (FS without a lead) and which may turn out implied (FS without a lag)
+    size_t m = graph.preds.size();
+    vector<uint8_t> follow(m);
+    vector<uint8_t> removable(m);
+    for (uint32_t e = 0; e < m; ++e) {
+        follow[e] = graph.predTypes[e] == FinishToStart && !(graph.predLags[e] < Time());
+        removable[e] = graph.predTypes[e] == FinishToStart && !(graph.predLags[e] > Time());
+    }
+    vector<uint32_t> post, low, postReversed, lowReversed;
+    getAncestorIntervals(graph, follow, false, post, low);
+    getAncestorIntervals(graph, follow, true, postReversed, lowReversed);
+
+    // First mark the implied dependencies, every task only touches the marks of its own edges
+    vector<uint8_t> implied(graph.preds.size(), 0);
+    atomic<size_t> nextTask{ 0 };
+    const size_t batchSize = 1024;
+    runOnThreads(threadCount, [&](unsigned) {
+        // Bitsets over all tasks are small enough to stay in cache, and only the bits that were
+        // set get cleared again
+        vector<uint64_t> isDependency((n + 63) / 64, 0);
+        vector<uint64_t> visited((n + 63) / 64, 0);
+        vector<TaskId> stack;
+        vector<TaskId> touched;
+        auto test = [](const vector<uint64_t>& bits, TaskId i) { return (bits[i >> 6] >> (i & 63)) & 1; };
+        auto set = [](vector<uint64_t>& bits, TaskId i) { bits[i >> 6] |= uint64_t(1) << (i & 63); };
+        auto clear = [](vector<uint64_t>& bits, TaskId i) { bits[i >> 6] &= ~(uint64_t(1) << (i & 63)); };
+
+        for (size_t first; (first = nextTask.fetch_add(batchSize)) < n;) {
+            for (TaskId t = (TaskId)first; t < min(n, first + batchSize); ++t) {
+                uint32_t rowStart = graph.predOffsets[t];
+                uint32_t rowEnd = graph.predOffsets[t + 1];
+                if (rowEnd - rowStart < 2) continue;
+
+                // Earliest dependency that could be implied, if there is any
+                uint32_t lowest = UINT32_MAX;
+                for (uint32_t e = rowStart; e < rowEnd; ++e) {
+                    if (removable[e]) lowest = min(lowest, rank[graph.preds[e]]);
+                }
+                if (lowest == UINT32_MAX) continue;
+
+                // Flag the dependencies, a repeated one is implied by an earlier copy the walks follow
+                for (uint32_t e = rowStart; e < rowEnd; ++e) {
+                    TaskId d = graph.preds[e];
+                    if (removable[e] && test(isDependency, d)) implied[e] = 1;
+                    if (follow[e]) set(isDependency, d);
+                }
+
+                // Walk up from the dependencies, any dependency found on the way is implied
+                // Only tasks that come after the earliest dependency and whose intervals hold one
+                // that hasn't been found yet can lead to one
+                auto mayLeadToDependency = [&](TaskId a) {
+                    if (rank[a] < lowest) return false;
+                    for (uint32_t e = rowStart; e < rowEnd; ++e) {
+                        TaskId d = graph.preds[e];
+                        if (removable[e] && !test(visited, d) && low[a] <= low[d] && post[d] <= post[a] &&
+                            lowReversed[a] <= lowReversed[d] && postReversed[d] <= postReversed[a]) return true;
+                    }
+                    return false;
+                };
+                // Depth first, so that a dependency far up is reached without going through
+                // everything in between
+                auto visit = [&](TaskId i) {
+                    for (uint32_t e = graph.predOffsets[i]; e < graph.predOffsets[i + 1]; ++e) {
+                        TaskId a = graph.preds[e];
+                        if (!follow[e] || test(visited, a) || !mayLeadToDependency(a)) continue;
+                        set(visited, a);
+                        touched.push_back(a);
+                        stack.push_back(a);
+                    }
+                };
+                for (uint32_t e = rowStart; e < rowEnd; ++e) {
+                    if (follow[e]) visit(graph.preds[e]);
+                }
+                while (!stack.empty() && touched.size() < maxWalk) {
+                    TaskId i = stack.back();
+                    stack.pop_back();
+                    // Skip tasks that were only headed for dependencies found since
+                    if (mayLeadToDependency(i)) visit(i);
+                }
+                for (uint32_t e = rowStart; e < rowEnd; ++e) {
+                    if (removable[e] && test(visited, graph.preds[e])) implied[e] = 1;
+                }
+
+                for (uint32_t e = rowStart; e < rowEnd; ++e) clear(isDependency, graph.preds[e]);
+                for (TaskId i : touched) clear(visited, i);
+                touched.clear();
+                stack.clear();
+            }
+        }
+    });
+
+    // Then squeeze the remaining dependencies together and rebuild the successors
+    size_t kept = 0;
+    uint32_t rowStart = 0;
+    for (TaskId t = 0; t < n; ++t) {
+        uint32_t rowEnd = graph.predOffsets[t + 1];
+        for (uint32_t e = rowStart; e < rowEnd; ++e) {
+            if (implied[e]) continue;
+            graph.preds[kept] = graph.preds[e];
+            graph.predTypes[kept] = graph.predTypes[e];
+            graph.predLags[kept] = graph.predLags[e];
+            kept++;
+        }
+        rowStart = rowEnd;
+        graph.predOffsets[t + 1] = (uint32_t)kept;
+    }
+    size_t removed = graph.preds.size() - kept;
+    graph.preds.resize(kept);
+    graph.predTypes.resize(kept);
+    graph.predLags.resize(kept);
+    populateSuccessors(graph);
+    return removed;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Forward pass for calculating early start (ES) and early finish (EF)                  //
+// Early Start (ES): the earliest time a task can start, considering its dependencies.  //
+//                   ES = max(EF of all dependencies)                                   //
+// If a task has no dependencies, we should be starting them at time 0 obviously        //
+// Early Finish (EF): the earliest time a task can finish.                              //
+//                   EF = ES of task + duration                                         //
+// A dependency with another link type or a lag (see LinkType) asks for a start of its  //
+// own instead, eg. ES >= ES of the dependency + lag for "SS+lag", and ES is the latest //
+// of them. Every link is still looked at once per pass, as in plain CPM.               //
+//                                                                                      //
+// Graph traversals never recurse: they run off the topological order or an explicit    //
+// queue/stack sized by the graph, so a chain of a million tasks needs no more stack    //
+// than a single task does. Keep it that way when adding new traversals.                //
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Computes a topological order of the tasks (every task comes after all of its dependencies)
+// using Kahn's algorithm, which visits every task and every dependency exactly once
+// The same order is reused by the forward pass and, reversed, by the backward pass
+vector<TaskId> getTopologicalOrder(const TaskGraph& graph) {
+    size_t n = graph.size();
+
+    // Number of unprocessed dependencies of each task
+    vector<uint32_t> remaining(n);
+    for (TaskId i = 0; i < n; ++i) remaining[i] = (uint32_t)graph.predecessors(i).size();
+
+    // Start with the tasks without dependencies, the order itself doubles as the queue
+    vector<TaskId> order;
+    order.reserve(n);
+    for (TaskId i = 0; i < n; ++i) {
+        if (remaining[i] == 0) order.push_back(i);
+    }
+    for (size_t head = 0; head < order.size(); ++head) {
+        for (TaskId s : graph.successors(order[head])) {
+            if (--remaining[s] == 0) order.push_back(s);
+        }
+    }
+
+    // Tasks that never became ready are waiting on each other
+    if (order.size() != n) throw runtime_error("Dependency cycle detected between tasks");
+    return order;
+}
+
+// Renumbers the tasks into topological order, so task i becomes order[i] and order itself
+// becomes 0, 1, 2, ... Kahn's algorithm hands out tasks a level at a time, so dependencies sit
+// before their successors and tasks that become ready together sit next to each other. The
+// passes then sweep the task table front to back (or back to front) and the tasks an edge
+// leads to are mostly close by, instead of wherever the csv happened to list them
+// The outputs keep the order the tasks were read in through project.readOrder
+template <typename Time>
+void renumberTasks(Project<Time>& project, vector<TaskId>& order) {
+    size_t n = order.size();
+    vector<TaskId> newId(n);
+    for (TaskId i = 0; i < n; ++i) newId[order[i]] = i;
+
+    // Build the dependency rows in the new order, the successors follow from them
+    LinkedTaskGraph<Time>& graph = project.graph;
+    LinkedTaskGraph<Time> renumbered;
+    renumbered.predOffsets.reserve(n + 1);
+    renumbered.predOffsets.push_back(0);
+    renumbered.preds.reserve(graph.preds.size());
+    renumbered.predTypes.reserve(graph.preds.size());
+    renumbered.predLags.reserve(graph.preds.size());
+    for (TaskId old : order) {
+        for (uint32_t e = graph.predOffsets[old]; e < graph.predOffsets[old + 1]; ++e) {
+            renumbered.preds.push_back(newId[graph.preds[e]]);
+            renumbered.predTypes.push_back(graph.predTypes[e]);
+            renumbered.predLags.push_back(graph.predLags[e]);
+        }
+        renumbered.predOffsets.push_back((uint32_t)renumbered.preds.size());
+    }
+    populateSuccessors(renumbered);
+    graph = move(renumbered);
+
+    project.tasks.permute(order);
+    indexTasksByName(project);
+
+    // A project renumbered before maps every task through its previous numbering
+    if (project.readOrder.empty()) project.readOrder = move(newId);
+    else for (TaskId& id : project.readOrder) id = newId[id];
+
+    for (TaskId i = 0; i < n; ++i) order[i] = i;
+}
+
+// What one link between dependency d and task i asks of the schedule, see LinkType
+// A plain finish to start link without lag comes down to ES[i] >= EF[d], LF[d] <= LS[i] and
+// a free float of ES[i] - EF[d] for d, as in plain CPM
+
+// Type and lag of link k of a row, on a graph without links (linked = false) every link is a
+// plain one, so the passes don't read the arrays at all
+template <bool linked, typename Time>
+inline uint8_t linkType(LinkRange<Time> links, size_t k) {
+    return linked ? links.types[k] : (uint8_t)FinishToStart;
+}
+
+template <bool linked, typename Time>
+inline Time linkLag(LinkRange<Time> links, size_t k) {
+    return linked ? links.lags[k] : Time();
+}
+
+// Earliest time the start of a task (or its finish, for a link to its finish) may be because of
+// the link from dependency d
+template <typename Time>
+inline Time linkRelease(const TaskTable<Time>& taskList, TaskId d, uint8_t type, Time lag) {
+    return ((type & linkFromStart) ? taskList.ES[d] : taskList.EF[d]) + lag;
+}
+
+// Latest time the start of a dependency (or its finish, for a link from its finish) may be
+// because of the link to task i, when task i starts at start[i] and finishes at finish[i]
+template <typename Time>
+inline Time linkDeadline(const vector<Time>& start, const vector<Time>& finish, uint8_t type, Time lag, TaskId i) {
+    return ((type & linkToFinish) ? finish[i] : start[i]) - lag;
+}
+
+// How the passes place a task between the bounds its links give, when every time unit is a
+// working one. These are the plain CPM sums, ES = start and EF = ES + duration and so on
+struct NoCalendars {
+    // Places task i as early as it can while starting at or after start and finishing at or after finish
+    template <typename Time>
+    void placeEarly(TaskTable<Time>& taskList, TaskId i, Time start, Time finish) const {
+        Time finishStart = finish - taskList.duration[i];
+        Time ES = finishStart > start ? finishStart : start;
+        taskList.ES[i] = ES;
+        taskList.EF[i] = ES + taskList.duration[i];
+    }
+
+    // Where the backward pass starts off task i when it has no successors, it ends the project
+    template <typename Time>
+    Time endFinish(const TaskTable<Time>& taskList, TaskId i) const {
+        return taskList.EF[i];
+    }
+
+    // Places task i as late as it can while starting at or before start and finishing at or
+    // before finish, start is TimeTraits<Time>::max() if nothing holds it back
+    template <typename Time>
+    void placeLate(TaskTable<Time>& taskList, TaskId i, Time start, Time finish) const {
+        Time LF = finish;
+        if (start != TimeTraits<Time>::max() && start + taskList.duration[i] < LF) LF = start + taskList.duration[i];
+        taskList.LF[i] = LF;
+        taskList.LS[i] = LF - taskList.duration[i];
+    }
+
+    // How long task d can slip before its start (or finish) goes past deadline
+    template <typename Time>
+    Time slip(const TaskTable<Time>& taskList, TaskId d, bool fromStart, Time deadline) const {
+        return deadline - (fromStart ? taskList.ES[d] : taskList.EF[d]);
+    }
+
+    template <typename Time>
+    Time slack(const TaskTable<Time>& taskList, TaskId i) const {
+        return taskList.LS[i] - taskList.ES[i];
+    }
+};
+
+// Same for tasks that work in calendars, every task in its own
+// A task of duration n > 0 that starts on working unit k works units k to k + n - 1 of its
+// calendar, so ES = U(k) and EF = U(k + n - 1) + 1. Milestones take no time and stay wherever
+// their links put them
+template <typename Time>
+struct TaskCalendars {
+    const WorkCalendar* calendars;
+    const CalendarId* calendarOf;
+
+    explicit TaskCalendars(const TaskTable<Time>& taskList) : calendars(taskList.calendars.data()), calendarOf(taskList.calendar.data()) {}
+
+    const WorkCalendar& of(TaskId i) const { return calendars[calendarOf[i]]; }
+
+    // U(k) >= start for k >= W(start), and U(k + n - 1) + 1 >= finish for k >= W(finish - 1) - n + 1
+    void placeEarly(TaskTable<Time>& taskList, TaskId i, Time start, Time finish) const {
+        Time duration = taskList.duration[i];
+        if (duration == Time()) {
+            taskList.ES[i] = taskList.EF[i] = finish > start ? finish : start;
+            return;
+        }
+        const WorkCalendar& calendar = of(i);
+        int64_t k = max(calendar.workBefore(start), calendar.workBefore(finish - 1) - duration + 1);
+        taskList.ES[i] = (Time)calendar.workUnit(k);
+        taskList.EF[i] = (Time)(calendar.workUnit(k + duration - 1) + 1);
+    }
+
+    Time endFinish(const TaskTable<Time>& taskList, TaskId i) const {
+        return taskList.EF[i];
+    }
+
+    // U(k) <= start for k <= W(start + 1) - 1, and U(k + n - 1) + 1 <= finish for k <= W(finish) - n
+    void placeLate(TaskTable<Time>& taskList, TaskId i, Time start, Time finish) const {
+        Time duration = taskList.duration[i];
+        if (duration == Time()) {
+            taskList.LS[i] = taskList.LF[i] = finish < start ? finish : start;
+            return;
+        }
+        const WorkCalendar& calendar = of(i);
+        int64_t k = calendar.workBefore(finish) - duration;
+        if (start != TimeTraits<Time>::max()) k = min(k, calendar.workBefore(start + 1) - 1);
+        taskList.LS[i] = (Time)calendar.workUnit(k);
+        taskList.LF[i] = (Time)(calendar.workUnit(k + duration - 1) + 1);
+    }
+
+    // Working units of d's calendar it can move on by
+    Time slip(const TaskTable<Time>& taskList, TaskId d, bool fromStart, Time deadline) const {
+        const WorkCalendar& calendar = of(d);
+        if (fromStart && taskList.duration[d] != Time()) return (Time)(calendar.workBefore(deadline + 1) - 1 - calendar.workBefore(taskList.ES[d]));
+        return (Time)(calendar.workBefore(deadline) - calendar.workBefore(fromStart ? taskList.ES[d] : taskList.EF[d]));
+    }
+
+    Time slack(const TaskTable<Time>& taskList, TaskId i) const {
+        const WorkCalendar& calendar = of(i);
+        return (Time)(calendar.workBefore(taskList.LS[i]) - calendar.workBefore(taskList.ES[i]));
+    }
+};
+
+// Calls visit(calendars) with TaskCalendars if the tasks work in calendars, NoCalendars otherwise
+// Only the whole number time types take calendars
+template <typename Time, typename Visit>
+inline void visitCalendars(const TaskTable<Time>& taskList, Visit visit) {
+    if constexpr (is_integral_v<Time>) {
+        if (!taskList.calendars.empty()) return visit(TaskCalendars<Time>(taskList));
+    }
+    visit(NoCalendars());
+}
+
+// Applies the constraints of the tasks and the project deadline on top of the placement of
+// another policy. They only move the bounds a task is placed between, so a task whose
+// dependencies push it past a constraint still follows them and ends up with negative slack
+template <typename Time, typename Placement>
+struct Constrained {
+    Placement placement;
+    const uint8_t* constraint;
+    const Time* constraintTime;
+    Time projectDeadline;
+
+    Constrained(const TaskTable<Time>& taskList, Placement inner)
+        : placement(inner), constraint(taskList.constraint.data()), constraintTime(taskList.constraintTime.data()), projectDeadline(taskList.deadline) {}
+
+    void placeEarly(TaskTable<Time>& taskList, TaskId i, Time start, Time finish) const {
+        uint8_t type = constraint[i];
+        if (type == StartNoEarlier || type == MustStartOn) start = max(start, constraintTime[i]);
+        else if (type == FinishNoEarlier || type == MustFinishOn) finish = max(finish, constraintTime[i]);
+        placement.placeEarly(taskList, i, start, finish);
+    }
+
+    Time endFinish(const TaskTable<Time>& taskList, TaskId i) const {
+        return projectDeadline != TimeTraits<Time>::max() ? projectDeadline : placement.endFinish(taskList, i);
+    }
+
+    void placeLate(TaskTable<Time>& taskList, TaskId i, Time start, Time finish) const {
+        uint8_t type = constraint[i];
+        if (type == StartNoLater || type == MustStartOn) start = min(start, constraintTime[i]);
+        else if (type == FinishNoLater || type == MustFinishOn) finish = min(finish, constraintTime[i]);
+        placement.placeLate(taskList, i, start, finish);
+    }
+
+    Time slip(const TaskTable<Time>& taskList, TaskId d, bool fromStart, Time deadline) const {
+        return placement.slip(taskList, d, fromStart, deadline);
+    }
+
+    Time slack(const TaskTable<Time>& taskList, TaskId i) const {
+        return placement.slack(taskList, i);
+    }
+};
+
+// Calls visit(placement) with the policy that places the tasks: the one of their calendars (see
+// visitCalendars), wrapped in Constrained when there are constraints or a deadline
+template <typename Time, typename Visit>
+inline void visitPlacement(const TaskTable<Time>& taskList, Visit visit) {
+    visitCalendars(taskList, [&](auto calendars) {
+        if (taskList.constrained) visit(Constrained<Time, decltype(calendars)>(taskList, calendars));
+        else visit(calendars);
+    });
+}
+
+// Calls pass(linked, placement) with linked a bool_constant of whether the graph has links and
+// the placement policy of the tasks, so that every pass is compiled for plain projects on its own
+template <typename Time, typename Pass>
+void runPass(const TaskTable<Time>& taskList, const LinkedTaskGraph<Time>& graph, Pass pass) {
+    visitPlacement(taskList, [&](auto placement) {
+        if (graph.linked) pass(true_type(), placement);
+        else pass(false_type(), placement);
+    });
+}
+
+// Updates the early start and finish of one task, the ES and EF of all its dependencies must be final
+// Graph is a LinkedTaskGraph or a DynamicTaskGraph, anything with predecessors(t), successors(t),
+// predLinks(t) and succLinks(t). The passes over a whole graph without links set linked to false,
+// and placement is NoCalendars or TaskCalendars, maybe Constrained, see visitPlacement
+template <bool linked = true, typename Time, typename Graph, typename Placement = NoCalendars>
+inline void updateEarlyVars(TaskTable<Time>& taskList, const Graph& graph, TaskId i, const Placement& placement = Placement()) {
+    // No dependencies -> ES = 0, otherwise the latest start and finish any of the links asks for
+    // (ES = max(EF of all dependencies) for plain ones), but never before 0
+    TaskRange preds = graph.predecessors(i);
+    LinkRange<Time> links = graph.predLinks(i);
+    Time start{};
+    Time finish{};
+    for (size_t k = 0; k < preds.size(); ++k) {
+        uint8_t type = linkType<linked>(links, k);
+        Time release = linkRelease(taskList, preds.begin()[k], type, linkLag<linked>(links, k));
+        if (type & linkToFinish) {
+            if (release > finish) finish = release;
+        }
+        else if (release > start) start = release;
+    }
+
+    // Update early start (ES) and ealy finish (EF)
+    placement.placeEarly(taskList, i, start, finish);
+}
+
+// Updates the early start and finish of every task in the task list by reference
+// Tasks are visited in topological order so the EF of every dependency is already final
+template <typename Time>
+void updateAllEarlyVars(TaskTable<Time>& taskList, const LinkedTaskGraph<Time>& graph, const vector<TaskId>& order) {
+    runPass(taskList, graph, [&](auto linked, auto placement) {
+        for (TaskId i : order) updateEarlyVars<decltype(linked)::value>(taskList, graph, i, placement);
+    });
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Backward pass for late start (LS) and late finish (LF)                               //
+// Late Finish (LF): the latest time a task can finish without delaying the project.    //
+// For the last task, LF = EF as the task has 0 successors)                           //
+// For other tasks                                                                      //
+//                  LF = min(LS of all successor tasks)                                 //
+//                  ie. Task must finish before the earliest LS of its successors,      //
+//                      otherwise one of them will be forced to start late.             //        
+// Early Finish (EF): the earliest time a task can finish.                              //
+//                   EF = ES of task + duration                                         //
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Updates the late start and finish of one task, the LS and LF of all its successors must be final
+template <bool linked = true, typename Time, typename Graph, typename Placement = NoCalendars>
+inline void updateLateVars(TaskTable<Time>& taskList, const Graph& graph, TaskId i, const Placement& placement = Placement()) {
+    TaskRange successors = graph.successors(i);
+    LinkRange<Time> links = graph.succLinks(i);
+
+    // No successors -> end of project -> LF = EF, or the deadline if there is one
+    // Otherwise takes the earliest start and finish any of the links asks for, which give the LF
+    // (the minimum late start of all its successors for plain ones)
+    Time start = TimeTraits<Time>::max();
+    Time finish = successors.empty() ? placement.endFinish(taskList, i) : TimeTraits<Time>::max();
+    for (size_t k = 0; k < successors.size(); ++k) {
+        uint8_t type = linkType<linked>(links, k);
+        Time deadline = linkDeadline(taskList.LS, taskList.LF, type, linkLag<linked>(links, k), successors.begin()[k]);
+        if (type & linkFromStart) {
+            if (deadline < start) start = deadline;
+        }
+        else if (deadline < finish) finish = deadline;
+    }
+
+    // Update late start (LS) and late finish (LF)
+    placement.placeLate(taskList, i, start, finish);
+}
+
+// Updates the late start and finish of every task in the task list by reference
+// Tasks are visited in reverse topological order so the LS of every successor is already final
+template <typename Time>
+void updateAllLateVars(TaskTable<Time>& taskList, const LinkedTaskGraph<Time>& graph, const vector<TaskId>& order) {
+    runPass(taskList, graph, [&](auto linked, auto placement) {
+        for (auto it = order.rbegin(); it != order.rend(); ++it) updateLateVars<decltype(linked)::value>(taskList, graph, *it, placement);
+    });
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Slack and floats                                                                     //
+// Slack (total float): how long a task can slip without delaying the project.          //
+//                  slack = LS - ES, and tasks with a slack of 0 or less are critical   //
+// Free float: how long a task can slip without delaying any of its successors.        //
+//                  free float = min(ES of all successors) - EF                         //
+//                  or LF - EF for a task without successors                            //
+//                  and with other link types the least slip any of its links allows   //
+// Slack and the critical flags only combine columns of the same task, so they are     //
+// computed by vectorized kernels that stream through the columns at memory speed.      //
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Signature shared by all slack kernels
+// Writes slack[i] = LS[i] - ES[i] and critical[i] = (slack[i] <= 0) for the first count tasks
+using SlackKernel = void (*)(const int32_t* ES, const int32_t* LS, int32_t* slack, uint8_t* critical, size_t count);
+
+// One task at a time, used on non-x86 cpus
+void computeSlackScalar(const int32_t* ES, const int32_t* LS, int32_t* slack, uint8_t* critical, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        slack[i] = LS[i] - ES[i];
+        critical[i] = slack[i] <= 0;
+    }
+}
+
+#ifdef ELIXIR_X86
+// 4 x 4 tasks per step
+void computeSlackSSE2(const int32_t* ES, const int32_t* LS, int32_t* slack, uint8_t* critical, size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i hasSlack[4];
+        for (int k = 0; k < 4; ++k) {
+            __m128i early = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ES + i + 4 * k));
+            __m128i late = _mm_loadu_si128(reinterpret_cast<const __m128i*>(LS + i + 4 * k));
+            __m128i difference = _mm_sub_epi32(late, early);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(slack + i + 4 * k), difference);
+            hasSlack[k] = _mm_cmpgt_epi32(difference, zero);
+        }
+
+        // Narrow the 16 all-ones or all-zeros lanes down to one byte each, critical where they are zeros
+        __m128i flags = _mm_packs_epi16(_mm_packs_epi32(hasSlack[0], hasSlack[1]), _mm_packs_epi32(hasSlack[2], hasSlack[3]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(critical + i), _mm_andnot_si128(flags, one));
+    }
+    computeSlackScalar(ES + i, LS + i, slack + i, critical + i, count - i);
+}
+
+// 4 x 8 tasks per step
+ELIXIR_TARGET_AVX2
+void computeSlackAVX2(const int32_t* ES, const int32_t* LS, int32_t* slack, uint8_t* critical, size_t count) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi8(1);
+    // The packs below work within each 128 bit half, this puts the 4 byte groups back in task order
+    const __m256i taskOrder = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i hasSlack[4];
+        for (int k = 0; k < 4; ++k) {
+            __m256i early = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ES + i + 8 * k));
+            __m256i late = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(LS + i + 8 * k));
+            __m256i difference = _mm256_sub_epi32(late, early);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(slack + i + 8 * k), difference);
+            hasSlack[k] = _mm256_cmpgt_epi32(difference, zero);
+        }
+
+        __m256i flags = _mm256_packs_epi16(_mm256_packs_epi32(hasSlack[0], hasSlack[1]), _mm256_packs_epi32(hasSlack[2], hasSlack[3]));
+        flags = _mm256_permutevar8x32_epi32(flags, taskOrder);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(critical + i), _mm256_andnot_si256(flags, one));
+    }
+    computeSlackScalar(ES + i, LS + i, slack + i, critical + i, count - i);
+}
+#endif
+
+// Picks the widest slack kernel the cpu supports, once
+SlackKernel getSlackKernel() {
+#ifdef ELIXIR_X86
+    static const SlackKernel kernel = cpuHasAVX2() ? computeSlackAVX2 : computeSlackSSE2;
+    return kernel;
+#else
+    return computeSlackScalar;
+#endif
+}
+
+// Update slack and critical flag of each task by reference
+// The wider time types are left to the compiler to vectorize, and so are tasks in calendars,
+// whose slack takes two table lookups
+template <typename Time>
+void updateAllSlack(TaskTable<Time>& taskList) {
+    visitCalendars(taskList, [&](auto calendars) {
+        for (TaskId i = 0; i < taskList.size(); ++i) {
+            taskList.slack[i] = calendars.slack(taskList, i);
+            taskList.critical[i] = taskList.slack[i] <= Time();
+        }
+    });
+}
+
+void updateAllSlack(TaskTable<int32_t>& taskList) {
+    if (!taskList.calendars.empty()) return updateAllSlack<int32_t>(taskList);
+    getSlackKernel()(taskList.ES.data(), taskList.LS.data(), taskList.slack.data(), taskList.critical.data(), taskList.size());
+}
+
+// Returns the free float of one task, the ES and EF of its successors and its own ES, EF and
+// LF must be final
+template <bool linked = true, typename Time, typename Graph, typename Placement = NoCalendars>
+inline Time getFreeFloat(const TaskTable<Time>& taskList, const Graph& graph, TaskId i, const Placement& placement = Placement()) {
+    TaskRange successors = graph.successors(i);
+    LinkRange<Time> links = graph.succLinks(i);
+    if (successors.empty()) return placement.slip(taskList, i, false, taskList.LF[i]);
+
+    Time freeFloat = TimeTraits<Time>::max();
+    for (size_t k = 0; k < successors.size(); ++k) {
+        uint8_t type = linkType<linked>(links, k);
+        Time deadline = linkDeadline(taskList.ES, taskList.EF, type, linkLag<linked>(links, k), successors.begin()[k]);
+        Time slip = placement.slip(taskList, i, type & linkFromStart, deadline);
+        if (slip < freeFloat) freeFloat = slip;
+    }
+    return freeFloat;
+}
+
+// Updates the slack, critical flag and free float of one task, for the incremental updates
+template <typename Time, typename Graph, typename Placement>
+inline void updateFloats(TaskTable<Time>& taskList, const Graph& graph, TaskId i, const Placement& placement) {
+    taskList.slack[i] = placement.slack(taskList, i);
+    taskList.critical[i] = taskList.slack[i] <= Time();
+    taskList.freeFloat[i] = getFreeFloat(taskList, graph, i, placement);
+}
+
+// Update free float of each task by reference
+// Looking up the successors is a gather over the graph rather than a stream, so this one
+// stays a plain loop
+template <typename Time>
+void updateAllFreeFloat(TaskTable<Time>& taskList, const LinkedTaskGraph<Time>& graph) {
+    runPass(taskList, graph, [&](auto linked, auto placement) {
+        for (TaskId i = 0; i < taskList.size(); ++i) taskList.freeFloat[i] = getFreeFloat<decltype(linked)::value>(taskList, graph, i, placement);
+    });
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Fused passes                                                                         //
+// The passes above sweep the tasks four times: forward, backward, slack and free       //
+// float, and the last two go back over columns the backward pass just had in cache.    //
+// The fused engine gets by with two sweeps. The forward sweep is the usual one, and    //
+// the reverse sweep reads the late and early times of the successors of a task in a   //
+// single loop and writes its whole schedule (LF, LS, slack, free float, critical) in   //
+// one go. In the order the tasks were read those writes land all over the columns, so  //
+// it pays off most on renumbered projects, where both sweeps walk the columns front to //
+// back.                                                                                //
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Computes the whole schedule in one forward and one reverse sweep over the order
+template <bool linked, typename Time, typename Placement>
+void runFusedSweeps(TaskTable<Time>& taskList, const LinkedTaskGraph<Time>& graph, const vector<TaskId>& order, const Placement& placement) {
+    for (TaskId i : order) updateEarlyVars<linked>(taskList, graph, i, placement);
+
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        TaskId i = *it;
+        TaskRange successors = graph.successors(i);
+        LinkRange<Time> links = graph.succLinks(i);
+
+        // The bounds of the backward pass and the free float, without successors LF = EF (or the deadline)
+        Time start = TimeTraits<Time>::max();
+        Time finish = successors.empty() ? placement.endFinish(taskList, i) : TimeTraits<Time>::max();
+        Time freeFloat = TimeTraits<Time>::max();
+        for (size_t k = 0; k < successors.size(); ++k) {
+            TaskId s = successors.begin()[k];
+            uint8_t type = linkType<linked>(links, k);
+            Time lag = linkLag<linked>(links, k);
+            Time deadline = linkDeadline(taskList.LS, taskList.LF, type, lag, s);
+            if (type & linkFromStart) {
+                if (deadline < start) start = deadline;
+            }
+            else if (deadline < finish) finish = deadline;
+            Time slip = placement.slip(taskList, i, type & linkFromStart, linkDeadline(taskList.ES, taskList.EF, type, lag, s));
+            if (slip < freeFloat) freeFloat = slip;
+        }
+
+        placement.placeLate(taskList, i, start, finish);
+        if (successors.empty()) freeFloat = placement.slip(taskList, i, false, taskList.LF[i]);
+        taskList.slack[i] = placement.slack(taskList, i);
+        taskList.critical[i] = taskList.slack[i] <= Time();
+        taskList.freeFloat[i] = freeFloat;
+    }
+}
+
+template <typename Time>
+void updateAllFused(TaskTable<Time>& taskList, const LinkedTaskGraph<Time>& graph, const vector<TaskId>& order) {
+    runPass(taskList, graph, [&](auto linked, auto placement) {
+        runFusedSweeps<decltype(linked)::value>(taskList, graph, order, placement);
+    });
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Parallel level-synchronous passes                                                    //
+// The level of a task is the length of the longest chain of dependencies leading up   //
+// to it, so all dependencies of a task sit on lower levels and all successors on       //
+// higher ones. Every task of a level can then be computed at the same time: the        //
+// forward pass runs the levels first to last and the backward pass last to first,     //
+// with all threads splitting up each level and meeting at a barrier before the next.   //
+// Runs of narrow levels aren't worth splitting, one thread sweeps through them alone.  //
+// Every task is computed from exactly the same inputs as in the serial passes, so the  //
+// results are identical.                                                               //
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Tasks grouped by level, level L holds tasks[offsets[L]] up to but excluding tasks[offsets[L + 1]]
+struct TaskLevels {
+    vector<uint32_t> offsets;
+    vector<TaskId> tasks;
+};
+
+// Groups the tasks by level with one sweep over the topological order and a counting sort
+TaskLevels getTopologicalLevels(const TaskGraph& graph, const vector<TaskId>& order) {
+    vector<uint32_t> level(graph.size(), 0);
+    uint32_t levelCount = 0;
+    for (TaskId i : order) {
+        for (TaskId d : graph.predecessors(i)) level[i] = max(level[i], level[d] + 1);
+        levelCount = max(levelCount, level[i] + 1);
+    }
+
+    TaskLevels levels;
+    levels.offsets.assign(levelCount + 1, 0);
+    for (uint32_t l : level) levels.offsets[l + 1]++;
+    for (uint32_t l = 0; l < levelCount; ++l) levels.offsets[l + 1] += levels.offsets[l];
+
+    levels.tasks.resize(graph.size());
+    vector<uint32_t> next(levels.offsets.begin(), levels.offsets.end() - 1);
+    for (TaskId i : order) levels.tasks[next[level[i]]++] = i;
+    return levels;
+}
+
+// Barrier for a fixed group of threads that can be reused any number of times
+// Waiting threads spin (yielding to the scheduler) rather than sleep, since the level passes
+// pass through it once per level and most levels take microseconds
+class SpinBarrier {
+public:
+    explicit SpinBarrier(unsigned count) : threadCount(count) {}
+
+    void wait() {
+        unsigned phase = generation.load(memory_order_acquire);
+        if (arrived.fetch_add(1, memory_order_acq_rel) + 1 == threadCount) {
+            arrived.store(0, memory_order_relaxed);
+            generation.fetch_add(1, memory_order_release);
+            return;
+        }
+        while (generation.load(memory_order_acquire) == phase) this_thread::yield();
+    }
+
+private:
+    unsigned threadCount;
+    atomic<unsigned> arrived{ 0 };
+    atomic<unsigned> generation{ 0 };
+};
+
+// Calls visit(task) for every task, level by level, on threadCount threads
+// Levels go first to last, or last to first when reverse is set
+template <typename Visit>
+void runLevels(const TaskLevels& levels, unsigned threadCount, bool reverse, Visit visit) {
+    // Threads claim tasks of a level in chunks, levels narrower than a few chunks per thread
+    // are merged with their neighbours into one serial step
+    const uint32_t chunkSize = 256;
+    const uint32_t minParallelWidth = chunkSize * max(2u, threadCount);
+
+    // A step is a range of levels.tasks, either split between the threads or swept by one
+    struct Step {
+        uint32_t first;
+        uint32_t last;
+        bool parallel;
+    };
+    vector<Step> steps;
+    size_t levelCount = levels.offsets.size() - 1;
+    for (size_t l = 0; l < levelCount; ++l) {
+        uint32_t first = levels.offsets[l];
+        uint32_t last = levels.offsets[l + 1];
+        bool parallel = threadCount > 1 && last - first >= minParallelWidth;
+        if (!parallel && !steps.empty() && !steps.back().parallel) steps.back().last = last;
+        else steps.push_back({ first, last, parallel });
+    }
+    if (reverse) std::reverse(steps.begin(), steps.end());
+
+    unique_ptr<atomic<uint32_t>[]> claimed(new atomic<uint32_t>[steps.size()]);
+    for (size_t k = 0; k < steps.size(); ++k) claimed[k].store(steps[k].first, memory_order_relaxed);
+
+    SpinBarrier barrier(threadCount);
+    runOnThreads(threadCount, [&](unsigned t) {
+        for (size_t k = 0; k < steps.size(); ++k) {
+            const Step& step = steps[k];
+            if (step.parallel) {
+                for (;;) {
+                    uint32_t first = claimed[k].fetch_add(chunkSize, memory_order_relaxed);
+                    if (first >= step.last) break;
+                    uint32_t last = min(step.last, first + chunkSize);
+                    for (uint32_t p = first; p < last; ++p) visit(levels.tasks[p]);
+                }
+            }
+            else if (t == 0) {
+                // The tasks of a serial step are in level order, which is a topological order
+                if (reverse) {
+                    for (uint32_t p = step.last; p > step.first; --p) visit(levels.tasks[p - 1]);
+                }
+                else {
+                    for (uint32_t p = step.first; p < step.last; ++p) visit(levels.tasks[p]);
+                }
+            }
+            barrier.wait();
+        }
+    });
+}
 
-    // Unknown information currently
-    // Will be populated later
-    vector<string> successors;
+// Parallel version of updateAllEarlyVars
+template <typename Time>
+void updateAllEarlyVarsParallel(TaskTable<Time>& taskList, const LinkedTaskGraph<Time>& graph, const TaskLevels& levels, unsigned threadCount) {
+    runPass(taskList, graph, [&](auto linked, auto placement) {
+        runLevels(levels, threadCount, false, [&](TaskId i) { updateEarlyVars<decltype(linked)::value>(taskList, graph, i, placement); });
+    });
+}
 
-    // Calculation for critical-path-method
-    int ES; // Early start
-    int EF; // Early finish
-    int LS; // Late start
-    int LF; // Late finish
-    int slack; // The amount of time a task can be delayed without affecting duration, 
-               // tasks not on the critical path with have a slack of > 0 while critical
-               // tasks have a slack = 0
-
-    // Constructor for task
-    Task(const string& taskName, int taskDuration, const vector<string>& deps = {})
-        : name(taskName), duration(taskDuration), dependencies(deps) 
-    {}
+// Parallel version of updateAllLateVars
+template <typename Time>
+void updateAllLateVarsParallel(TaskTable<Time>& taskList, const LinkedTaskGraph<Time>& graph, const TaskLevels& levels, unsigned threadCount) {
+    runPass(taskList, graph, [&](auto linked, auto placement) {
+        runLevels(levels, threadCount, true, [&](TaskId i) { updateLateVars<decltype(linked)::value>(taskList, graph, i, placement); });
+    });
+}
 
-};  
+//////////////////////////////////////////////////////////////////////////////////////////
+// Parallel dataflow passes                                                             //
+// Instead of waiting for whole levels, every task carries an atomic count of the       //
+// neighbours it is still waiting on (dependencies in the forward pass, successors in   //
+// the backward pass). The thread that finishes the last of them makes the task ready   //
+// and pushes it onto its own deque; threads that run out of work steal from the other  //
+// end of somebody else's deque. Deep and narrow plans keep every core busy this way,   //
+// with no global barrier anywhere, and each task still computes from final inputs, so  //
+// the results match the serial passes exactly.                                         //
+//////////////////////////////////////////////////////////////////////////////////////////
 
+// Chase-Lev work-stealing deque of task ids
+// The owning thread pushes and pops at the bottom, any other thread steals from the top, all
+// without locks. Follows "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al.)
+// The buffer grows as needed and old buffers are kept until the deque is destroyed, since a
+// thief may still be reading from one
+class WorkStealingDeque {
+public:
+    WorkStealingDeque() {
+        buffers.emplace_back(new Buffer(1024));
+        buffer.store(buffers.back().get(), memory_order_relaxed);
+    }
 
-// Helper function to split string by semicolon
-vector<string> splitDependencies(const string& s, char separator = ';') {
-    vector<string> result;
-    stringstream ss(s);
-    string item;
-    while (getline(ss, item, separator)) {
-        if (!item.empty()) {
-            result.push_back(item);
-        }
+    // Owner only
+    void push(TaskId task) {
+        int64_t b = bottom.load(memory_order_relaxed);
+        int64_t t = top.load(memory_order_acquire);
+        Buffer* a = buffer.load(memory_order_relaxed);
+        if (b - t > (int64_t)a->capacity - 1) a = grow(a, t, b);
+        a->put(b, task);
+        bottom.store(b + 1, memory_order_release);
     }
-    return result;
-}
 
-// Function to load csv of tasks into a vector
-// CSV file should be formatted as
-/*
-    task,duration,dependencies
-    a,2,
-    b,3,a
-    c,2,a
-    d,5,b;c                 
-*/
-vector<Task> loadCSV(const string& filename) {
-    vector<Task> tasks;
-    ifstream file(filename);
+    // Owner only, takes the most recently pushed task
+    bool pop(TaskId& task) {
+        int64_t b = bottom.load(memory_order_relaxed) - 1;
+        Buffer* a = buffer.load(memory_order_relaxed);
+        bottom.store(b, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        int64_t t = top.load(memory_order_relaxed);
 
-    // Opens csv file
-    if (!file.is_open()) {
-        cerr << "Failed to open file: " << filename << endl;
-        return tasks;
+        if (t > b) {
+            // Empty
+            bottom.store(b + 1, memory_order_relaxed);
+            return false;
+        }
+        task = a->get(b);
+        if (t == b) {
+            // Last task, race the thieves for it
+            bool won = top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+            bottom.store(b + 1, memory_order_relaxed);
+            return won;
+        }
+        return true;
     }
 
-    string line;
-    // Process every line in the csv except the first line, which contains the headers
-    bool startProcessingLines = false;
-    while (getline(file, line)) {
-        if (startProcessingLines == true){
-            stringstream ss(line);
-            string cell;
-            vector<string> row;
+    // Any thread, takes the oldest task
+    bool steal(TaskId& task) {
+        int64_t t = top.load(memory_order_acquire);
+        atomic_thread_fence(memory_order_seq_cst);
+        int64_t b = bottom.load(memory_order_acquire);
+        if (t >= b) return false;
 
-            // Split by comma
-            while (getline(ss, cell, ',')) {  
-                // For each column
-                row.push_back(cell);
-            }
+        Buffer* a = buffer.load(memory_order_acquire);
+        task = a->get(t);
+        return top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+    }
 
-            Task t(row[0], stoi(row[1]), row.size() == 3 ? splitDependencies(row[2], ';') : vector<string>{});
-            
-            tasks.push_back(t);
-        }
+private:
+    // Ring buffer with a power of two capacity
+    struct Buffer {
+        size_t capacity;
+        unique_ptr<atomic<TaskId>[]> slots;
+
+        explicit Buffer(size_t size) : capacity(size), slots(new atomic<TaskId>[size]) {}
+        TaskId get(int64_t i) const { return slots[(size_t)i & (capacity - 1)].load(memory_order_relaxed); }
+        void put(int64_t i, TaskId task) { slots[(size_t)i & (capacity - 1)].store(task, memory_order_relaxed); }
+    };
 
-        startProcessingLines = true;    
+    Buffer* grow(Buffer* old, int64_t t, int64_t b) {
+        buffers.emplace_back(new Buffer(old->capacity * 2));
+        Buffer* a = buffers.back().get();
+        for (int64_t i = t; i < b; ++i) a->put(i, old->get(i));
+        buffer.store(a, memory_order_release);
+        return a;
     }
 
-    file.close();
-    return tasks;
-}
+    atomic<int64_t> top{ 0 };
+    atomic<int64_t> bottom{ 0 };
+    atomic<Buffer*> buffer{ nullptr };
+    vector<unique_ptr<Buffer>> buffers; // Touched by the owner only
+};
 
-// Debug printing for tasklist
-void debugPrint(const vector<Task>& tasks){
-    for (auto& t : tasks) {
-        cout << "Task: " << t.name << ", Duration: " << t.duration << ", Dependencies: ";
-        for (auto d : t.dependencies) cout << d << "; ";
-        cout << endl;
+// Calls visit(task) for every task on threadCount threads, each task once all of its
+// dependencies (or all of its successors when reverse is set) have been visited
+template <typename Visit>
+void runDataflow(const TaskGraph& graph, unsigned threadCount, bool reverse, Visit visit) {
+    size_t n = graph.size();
+    if (n == 0) return;
+    auto waitingOn = [&](TaskId i) { return reverse ? graph.successors(i) : graph.predecessors(i); };
+    auto releases = [&](TaskId i) { return reverse ? graph.predecessors(i) : graph.successors(i); };
+
+    // Hand the tasks that are ready from the start out round robin
+    unique_ptr<atomic<uint32_t>[]> pending(new atomic<uint32_t>[n]);
+    vector<WorkStealingDeque> deques(threadCount);
+    unsigned nextDeque = 0;
+    for (TaskId i = 0; i < n; ++i) {
+        uint32_t count = (uint32_t)waitingOn(i).size();
+        pending[i].store(count, memory_order_relaxed);
+        if (count == 0) {
+            deques[nextDeque].push(i);
+            nextDeque = (nextDeque + 1) % threadCount;
+        }
     }
+
+    // Finished tasks are counted locally and published whenever a thread runs dry, all threads
+    // stop once every task is accounted for
+    atomic<size_t> finished{ 0 };
+    runOnThreads(threadCount, [&](unsigned self) {
+        WorkStealingDeque& own = deques[self];
+        uint32_t random = self * 2654435761u + 1;
+        size_t done = 0;
+
+        for (;;) {
+            TaskId task;
+            bool found = own.pop(task);
+            for (unsigned attempt = 0; !found && attempt < threadCount - 1; ++attempt) {
+                random ^= random << 13;
+                random ^= random >> 17;
+                random ^= random << 5;
+                unsigned victim = random % threadCount;
+                if (victim != self) found = deques[victim].steal(task);
+            }
+
+            if (found) {
+                visit(task);
+                for (TaskId next : releases(task)) {
+                    if (pending[next].fetch_sub(1, memory_order_acq_rel) == 1) own.push(next);
+                }
+                done++;
+                continue;
+            }
+
+            if (done > 0) {
+                finished.fetch_add(done, memory_order_acq_rel);
+                done = 0;
+            }
+            if (finished.load(memory_order_acquire) == n) break;
+            this_thread::yield();
+        }
+    });
 }
 
-// Helper function to get task from tasklist by name
-const Task& getTaskFromList(const string& name, const vector<Task>& taskList) {
-    for (auto& t : taskList) {
-        if (t.name == name) return t;
-    }
-    throw runtime_error("Task not found: " + name);
+// Dataflow version of updateAllEarlyVars
+template <typename Time>
+void updateAllEarlyVarsDataflow(TaskTable<Time>& taskList, const LinkedTaskGraph<Time>& graph, unsigned threadCount) {
+    runPass(taskList, graph, [&](auto linked, auto placement) {
+        runDataflow(graph, threadCount, false, [&](TaskId i) { updateEarlyVars<decltype(linked)::value>(taskList, graph, i, placement); });
+    });
 }
 
-// Returns the task reference instead of the const task reference so that it can be updated by reference
-Task& getTaskRefFromList(const string& name, vector<Task>& taskList) {
-    for (auto& t : taskList) {
-        if (t.name == name) return t; 
-    }
-    throw runtime_error("Task not found: " + name);
+// Dataflow version of updateAllLateVars
+template <typename Time>
+void updateAllLateVarsDataflow(TaskTable<Time>& taskList, const LinkedTaskGraph<Time>& graph, unsigned threadCount) {
+    runPass(taskList, graph, [&](auto linked, auto placement) {
+        runDataflow(graph, threadCount, true, [&](TaskId i) { updateLateVars<decltype(linked)::value>(taskList, graph, i, placement); });
+    });
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// Forward pass for calculating early start (ES) and early finish (EF)                  //
-// Early Start (ES): the earliest time a task can start, considering its dependencies.  //
-//                   ES = max(EF of all dependencies)                                   //
-// If a task has no dependencies, we should be starting them at time 0 obviously        //
-// Early Finish (EF): the earliest time a task can finish.                              //
-//                   EF = ES of task + duration                                         //
+// Incremental updates                                                                  //
+// Changing the duration of one task only moves the tasks it can reach: its descendants //
+// may start and finish later or earlier, and its ancestors (plus every project end     //
+// whose finish moved) may get a different late start. Both passes therefore restart    //
+// from the edited task and follow edges only while values keep changing. Tasks are     //
+// taken from a heap keyed by their position in the topological order, lowest first     //
+// forward and highest first backward, so every task is recomputed once, after all of   //
+// the tasks it reads from. The results are exactly those of a full rerun.              //
+//                                                                                      //
+// The graph itself may change too (see ProjectEditor), as long as the topological      //
+// order is kept valid. A new edge that points backwards in the order only reorders the //
+// tasks between its two ends that have to move, as in Pearce and Kelly's "A Dynamic    //
+// Topological Sort Algorithm for Directed Acyclic Graphs", and if the search runs into //
+// the dependency it started from, the edge would close a cycle.                        //
 //////////////////////////////////////////////////////////////////////////////////////////
 
-// Computes the early start score of a task recursively
-// Some resemblance to the "minimax" algorithm
-int getEarlyStartScore(const Task& task, const vector<Task>& taskList) {
-    // No dependencies
-    if (task.dependencies.empty()) return 0; 
+// Keeps the schedule of tasks up to date while durations and dependencies change
+// The tasks must already be scheduled with graph, and order must be a topological order of it
+template <typename Time, typename Graph>
+class ScheduleUpdater {
+public:
+    ScheduleUpdater(TaskTable<Time>& tasks, const Graph& graph, const vector<TaskId>& order)
+        : tasks(tasks), graph(graph), order(order), rank(order.size()), queuedIn(order.size(), 0) {
+        for (uint32_t r = 0; r < order.size(); ++r) rank[order[r]] = r;
+    }
 
-    int ES = 0;
-    // For each task, go through its dependencies and update the early start
-    for (const string& depName : task.dependencies) {
-        const Task& depTask = getTaskFromList(depName, taskList);
-        int depEF = getEarlyStartScore(depTask, taskList) + depTask.duration;
+    // Sets the duration of a task and updates the schedule and floats of every task it affects
+    // Returns how many tasks were recomputed
+    size_t setDuration(TaskId task, Time duration) {
+        if (duration < Time()) throw runtime_error("Duration can't be negative");
+        if (tasks.duration[task] == duration) return 0;
+        tasks.duration[task] = duration;
+        return update({ task }, { task });
+    }
 
-        // Since ES = max(EF of all dependencies)
-        if (depEF > ES) ES = depEF;
+    // Recomputes the early times of the tasks in forward and the late times of the tasks in
+    // backward, and of everything that changes because of them, returns how many tasks were recomputed
+    size_t update(const vector<TaskId>& forward, const vector<TaskId>& backward) {
+        size_t recomputed = 0;
+        visitPlacement(tasks, [&](auto placement) { recomputed = propagate(forward, backward, placement); });
+        return recomputed;
     }
 
-    return ES;
-}
+    // Must be called before task gets dependency as a new dependency, reorders the tasks if needed
+    // Returns false, changing nothing, if the dependency would close a cycle
+    bool orderDependency(TaskId task, TaskId dependency) {
+        if (task == dependency) return false;
+        uint32_t lowest = rank[task];
+        uint32_t highest = rank[dependency];
+        if (highest < lowest) return true;
+
+        // Tasks reachable from task that sit before the dependency in the order
+        startPass();
+        vector<TaskId> after = collectAffected(task, [&](TaskId i) { return graph.successors(i); },
+                                               [&](TaskId i) { return rank[i] <= highest; }, dependency);
+        if (after.empty()) return false;
+
+        // Tasks that the dependency depends on that sit after task in the order
+        vector<TaskId> before = collectAffected(dependency, [&](TaskId i) { return graph.predecessors(i); },
+                                                [&](TaskId i) { return rank[i] >= lowest; }, noTask);
+
+        // Hand the ranks these tasks had back out, first to the ones before and then to the ones after
+        // (both keeping their relative order), which puts the dependency in front of task
+        auto byRank = [&](TaskId a, TaskId b) { return rank[a] < rank[b]; };
+        sort(after.begin(), after.end(), byRank);
+        sort(before.begin(), before.end(), byRank);
+        vector<uint32_t> ranks;
+        ranks.reserve(before.size() + after.size());
+        for (TaskId i : before) ranks.push_back(rank[i]);
+        for (TaskId i : after) ranks.push_back(rank[i]);
+        sort(ranks.begin(), ranks.end());
 
-// Updates all early start and finish of task structure in task list by reference
-void updateAllEarlyVars(vector<Task>& taskList) {
-    // For each task in our task list
-    for (Task& task : taskList){
-        // Update early start (ES) and ealy finish (EF)
-        task.ES = getEarlyStartScore(task, taskList);
-        task.EF = task.ES + task.duration; 
+        size_t next = 0;
+        for (TaskId i : before) place(i, ranks[next++]);
+        for (TaskId i : after) place(i, ranks[next++]);
+        return true;
+    }
+
+    // Must be called after a task without dependencies or successors was appended, it goes last in the order
+    void addTask(TaskId task) {
+        rank.push_back((uint32_t)order.size());
+        order.push_back(task);
+        queuedIn.push_back(0);
+    }
+
+    // Must be called when task is removed and last, the last task, takes over its id
+    // The rank of the removed task stays empty, the order doesn't need to be contiguous
+    void removeTask(TaskId task, TaskId last) {
+        order[rank[task]] = noTask;
+        if (task != last) {
+            rank[task] = rank[last];
+            order[rank[task]] = task;
+        }
+        rank.pop_back();
+        queuedIn.pop_back();
+    }
+
+private:
+    // update() in the calendars of the tasks
+    template <typename Placement>
+    size_t propagate(const vector<TaskId>& forward, const vector<TaskId>& backward, const Placement& placement) {
+        size_t recomputed = 0;
+
+        // Forward: a task whose ES or EF moved moves its successors (links may start from
+        // either end) and changes the free float of its dependencies. A project end whose EF
+        // moved moves its own LF and so has to be redone backward too
+        vector<TaskId> movedEnds;
+        startPass();
+        for (TaskId i : forward) enqueue(i, greater<uint32_t>());
+        while (!heap.empty()) {
+            TaskId i = dequeue(greater<uint32_t>());
+            Time oldES = tasks.ES[i];
+            Time oldEF = tasks.EF[i];
+            updateEarlyVars(tasks, graph, i, placement);
+            updateFloats(tasks, graph, i, placement);
+            recomputed++;
+
+            if (tasks.ES[i] == oldES && tasks.EF[i] == oldEF) continue;
+            for (TaskId d : graph.predecessors(i)) tasks.freeFloat[d] = getFreeFloat(tasks, graph, d, placement);
+            TaskRange successors = graph.successors(i);
+            if (successors.empty() && tasks.EF[i] != oldEF) movedEnds.push_back(i);
+            for (TaskId s : successors) enqueue(s, greater<uint32_t>());
+        }
+
+        // Backward: a task whose LS or LF moved moves the LF of its dependencies
+        startPass();
+        for (TaskId i : backward) enqueue(i, less<uint32_t>());
+        for (TaskId i : movedEnds) enqueue(i, less<uint32_t>());
+        while (!heap.empty()) {
+            TaskId i = dequeue(less<uint32_t>());
+            Time oldLS = tasks.LS[i];
+            Time oldLF = tasks.LF[i];
+            updateLateVars(tasks, graph, i, placement);
+            updateFloats(tasks, graph, i, placement);
+            recomputed++;
+
+            if (tasks.LS[i] == oldLS && tasks.LF[i] == oldLF) continue;
+            for (TaskId d : graph.predecessors(i)) enqueue(d, less<uint32_t>());
+        }
+        return recomputed;
+    }
+
+    // Empties the heap and moves on to a new pass number, which drops the queued marks of the
+    // previous pass without clearing them
+    void startPass() {
+        heap.clear();
+        if (++pass == 0) {
+            fill(queuedIn.begin(), queuedIn.end(), 0);
+            pass = 1;
+        }
+    }
+
+    // Queues a task unless it already is, the heap holds topological ranks rather than tasks
+    template <typename Compare>
+    void enqueue(TaskId i, Compare compare) {
+        if (queuedIn[i] == pass) return;
+        queuedIn[i] = pass;
+        heap.push_back(rank[i]);
+        push_heap(heap.begin(), heap.end(), compare);
+    }
+
+    // Takes the lowest ranked task off the heap with greater, the highest with less
+    template <typename Compare>
+    TaskId dequeue(Compare compare) {
+        pop_heap(heap.begin(), heap.end(), compare);
+        TaskId i = order[heap.back()];
+        heap.pop_back();
+        return i;
+    }
+
+    // Depth first search from start along next(i) through the tasks that are inside(i), with an
+    // explicit stack, returns every task visited or nothing at all if it reaches stop
+    template <typename Next, typename Inside>
+    vector<TaskId> collectAffected(TaskId start, Next next, Inside inside, TaskId stop) {
+        vector<TaskId> visited;
+        vector<TaskId> stack = { start };
+        queuedIn[start] = pass;
+        while (!stack.empty()) {
+            TaskId i = stack.back();
+            stack.pop_back();
+            visited.push_back(i);
+            for (TaskId j : next(i)) {
+                if (j == stop) return {};
+                if (queuedIn[j] == pass || !inside(j)) continue;
+                queuedIn[j] = pass;
+                stack.push_back(j);
+            }
+        }
+        return visited;
+    }
+
+    void place(TaskId task, uint32_t r) {
+        rank[task] = r;
+        order[r] = task;
+    }
+
+    TaskTable<Time>& tasks;
+    const Graph& graph;
+    vector<TaskId> order;      // Tasks by rank, the ranks of removed tasks hold noTask
+    vector<uint32_t> rank;     // Position of every task in the order
+    vector<uint32_t> queuedIn; // Last pass each task was queued or visited in
+    uint32_t pass = 0;
+    vector<uint32_t> heap;
+};
+
+// Growable row of links of a DynamicTaskGraph, link k goes to tasks[k]
+template <typename Time>
+struct LinkList {
+    vector<TaskId> tasks;
+    vector<uint8_t> types;
+    vector<Time> lags;
+
+    size_t size() const { return tasks.size(); }
+
+    void add(TaskId task, uint8_t type, Time lag) {
+        tasks.push_back(task);
+        types.push_back(type);
+        lags.push_back(lag);
+    }
+
+    // Returns the index of the first link to task, or size() if there is none
+    size_t find(TaskId task) const {
+        return std::find(tasks.begin(), tasks.end(), task) - tasks.begin();
+    }
+
+    // Same for a link of the given type and lag
+    size_t find(TaskId task, uint8_t type, Time lag) const {
+        for (size_t k = 0; k < size(); ++k) {
+            if (tasks[k] == task && types[k] == type && lags[k] == lag) return k;
+        }
+        return size();
+    }
+
+    // Removes link k without keeping the order
+    void eraseAt(size_t k) {
+        tasks[k] = tasks.back();
+        types[k] = types.back();
+        lags[k] = lags.back();
+        tasks.pop_back();
+        types.pop_back();
+        lags.pop_back();
+    }
+};
+
+// Dependency graph with a growable list per task in both directions, for editing
+template <typename Time>
+struct DynamicTaskGraph {
+    vector<LinkList<Time>> preds;
+    vector<LinkList<Time>> succs;
+
+    explicit DynamicTaskGraph(const LinkedTaskGraph<Time>& graph) : preds(graph.size()), succs(graph.size()) {
+        for (TaskId t = 0; t < graph.size(); ++t) {
+            for (uint32_t e = graph.predOffsets[t]; e < graph.predOffsets[t + 1]; ++e) preds[t].add(graph.preds[e], graph.predTypes[e], graph.predLags[e]);
+            for (uint32_t e = graph.succOffsets[t]; e < graph.succOffsets[t + 1]; ++e) succs[t].add(graph.succs[e], graph.succTypes[e], graph.succLags[e]);
+        }
+    }
+
+    size_t size() const { return preds.size(); }
+
+    TaskRange predecessors(TaskId t) const { return { preds[t].tasks.data(), preds[t].tasks.data() + preds[t].size() }; }
+    TaskRange successors(TaskId t) const { return { succs[t].tasks.data(), succs[t].tasks.data() + succs[t].size() }; }
+    LinkRange<Time> predLinks(TaskId t) const { return { preds[t].types.data(), preds[t].lags.data() }; }
+    LinkRange<Time> succLinks(TaskId t) const { return { succs[t].types.data(), succs[t].lags.data() }; }
+};
+
+// Adds, removes and changes tasks and dependencies of a scheduled project, keeping every
+// ES, EF, LS, LF and slack up to date after each edit by recomputing only what it changes
+// The project's own graph is out of date until storeGraph() is called
+template <typename Time>
+class ProjectEditor {
+public:
+    ProjectEditor(Project<Time>& project, const vector<TaskId>& order)
+        : project(project), graph(project.graph), schedule(project.tasks, graph, order) {}
+
+    // Adds a task without dependencies and returns its id
+    TaskId addTask(string_view name, Time duration) {
+        if (duration < Time()) throw runtime_error("Duration can't be negative");
+        NameId id = project.names.find(name);
+        if (id != noName && project.taskByName[id] != noTask) throw runtime_error("Task already exists: " + string(name));
+        id = project.names.intern(name);
+        project.taskByName.resize(project.names.size(), noTask);
+
+        // A task on its own starts as soon as its calendar lets it and is its own project end,
+        // so it is critical
+        TaskId task = project.tasks.add(id, duration);
+        project.taskByName[id] = task;
+        if (!project.readOrder.empty()) project.readOrder.push_back(task);
+        graph.preds.emplace_back();
+        graph.succs.emplace_back();
+        schedule.addTask(task);
+        schedule.update({ task }, { task });
+        return task;
+    }
+
+    // Removes a task and all of its dependencies, the last task takes over its id
+    void removeTask(TaskId task) {
+        // Until now the ids were the order the tasks were read in, which moving the last task breaks
+        if (project.readOrder.empty()) {
+            for (TaskId i = 0; i < project.tasks.size(); ++i) project.readOrder.push_back(i);
+        }
+        const LinkList<Time>& succs = graph.succs[task];
+        const LinkList<Time>& preds = graph.preds[task];
+        for (size_t k = 0; k < succs.size(); ++k) {
+            LinkList<Time>& other = graph.preds[succs.tasks[k]];
+            other.eraseAt(other.find(task, succs.types[k], succs.lags[k]));
+        }
+        for (size_t k = 0; k < preds.size(); ++k) {
+            LinkList<Time>& other = graph.succs[preds.tasks[k]];
+            other.eraseAt(other.find(task, preds.types[k], preds.lags[k]));
+        }
+        vector<TaskId> forward = succs.tasks;
+        vector<TaskId> backward = preds.tasks;
+
+        // Move the last task into the hole and point its neighbours at the new id
+        TaskId last = (TaskId)project.tasks.size() - 1;
+        project.taskByName[project.tasks.name[task]] = noTask;
+        schedule.removeTask(task, last);
+        if (task != last) {
+            project.tasks.copy(last, task);
+            project.taskByName[project.tasks.name[task]] = task;
+            graph.preds[task] = move(graph.preds[last]);
+            graph.succs[task] = move(graph.succs[last]);
+            for (TaskId d : graph.preds[task].tasks) replace(graph.succs[d].tasks.begin(), graph.succs[d].tasks.end(), last, task);
+            for (TaskId s : graph.succs[task].tasks) replace(graph.preds[s].tasks.begin(), graph.preds[s].tasks.end(), last, task);
+            replace(forward.begin(), forward.end(), last, task);
+            replace(backward.begin(), backward.end(), last, task);
+        }
+        project.tasks.removeLast();
+        graph.preds.pop_back();
+        if (!project.readOrder.empty()) {
+            project.readOrder.erase(find(project.readOrder.begin(), project.readOrder.end(), task));
+            replace(project.readOrder.begin(), project.readOrder.end(), last, task);
+        }
+        graph.succs.pop_back();
+        schedule.update(forward, backward);
+    }
+
+    // Makes task depend on dependency through a link of the given type and lag, returns false
+    // without changing anything if that would create a dependency cycle
+    bool addDependency(TaskId task, TaskId dependency, LinkType type = FinishToStart, Time lag = Time()) {
+        LinkList<Time>& preds = graph.preds[task];
+        if (preds.find(dependency, type, lag) != preds.size()) return true;
+        if (!schedule.orderDependency(task, dependency)) return false;
+
+        preds.add(dependency, type, lag);
+        graph.succs[dependency].add(task, type, lag);
+        schedule.update({ task }, { dependency });
+        return true;
     }
-}
+
+    // Removes every link between task and dependency, returns false if task didn't depend on dependency
+    bool removeDependency(TaskId task, TaskId dependency) {
+        LinkList<Time>& preds = graph.preds[task];
+        LinkList<Time>& succs = graph.succs[dependency];
+        if (preds.find(dependency) == preds.size()) return false;
+        for (size_t k; (k = preds.find(dependency)) != preds.size();) preds.eraseAt(k);
+        for (size_t k; (k = succs.find(task)) != succs.size();) succs.eraseAt(k);
+        schedule.update({ task }, { dependency });
+        return true;
+    }
+
+    void setDuration(TaskId task, Time duration) { schedule.setDuration(task, duration); }
+
+    // Writes the edited graph back into the project, eg. before compiling it
+    void storeGraph() {
+        LinkedTaskGraph<Time>& stored = project.graph;
+        stored.predOffsets.assign(1, 0);
+        stored.preds.clear();
+        stored.predTypes.clear();
+        stored.predLags.clear();
+        for (const LinkList<Time>& preds : graph.preds) {
+            stored.preds.insert(stored.preds.end(), preds.tasks.begin(), preds.tasks.end());
+            stored.predTypes.insert(stored.predTypes.end(), preds.types.begin(), preds.types.end());
+            stored.predLags.insert(stored.predLags.end(), preds.lags.begin(), preds.lags.end());
+            stored.predOffsets.push_back((uint32_t)stored.preds.size());
+        }
+        populateSuccessors(stored);
+    }
+
+private:
+    Project<Time>& project;
+    DynamicTaskGraph<Time> graph;
+    ScheduleUpdater<Time, DynamicTaskGraph<Time>> schedule;
+};
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// Backward pass for late start (LS) and late finish (LF)                               //
-// Late Finish (LF): the latest time a task can finish without delaying the project.    //
-// For the last task, LF = EF as the task has 0 successors)                           //
-// For other tasks                                                                      //
-//                  LF = min(LS of all successor tasks)                                 //
-//                  ie. Task must finish before the earliest LS of its successors,      //
-//                      otherwise one of them will be forced to start late.             //        
-// Early Finish (EF): the earliest time a task can finish.                              //
-//                   EF = ES of task + duration                                         //
+// Resource-constrained scheduling                                                      //
+// The passes above start every task as soon as its dependencies let it, which a plan   //
+// whose tasks share cranes or crews can't always do. The serial schedule generation    //
+// scheme places the tasks one at a time instead: out of the tasks whose dependencies   //
+// are all placed it takes the one a priority rule ranks first, and starts it at the    //
+// earliest time its links allow at which every resource it needs has enough free for   //
+// its whole run. It starts from the CPM schedule, whose ES bounds every start and whose//
+// LF and slack drive the priority rules, and places every task once, so the run is a   //
+// single sweep plus the searches for free resources.                                   //
+// How much of a resource is free over time is a step function, kept as the sorted      //
+// times it changes at, split into small blocks that know the least and most free in    //
+// them. A search skips every block where the resource is too busy (or where nothing    //
+// is short) instead of walking each task that used the resource so far.                //
 //////////////////////////////////////////////////////////////////////////////////////////
 
-// Populate successors for all tasks
-void populateSuccessors(vector<Task>& taskList) {
-    // For each task in tasklist
-    for (auto& t : taskList) {
-        // For each of its dependencies
-        for (const string& depName : t.dependencies) {
-            // The dependencies of a task means that the task is the successor of the dependencies
-            Task& depTask = getTaskRefFromList(depName, taskList);
-            depTask.successors.push_back(t.name);
+// Free amount of one resource over time, from time 0 on
+// Every block holds a run of the times the free amount changes at, and free[k] is what is free
+// from times[k] until the next time. Everything is free again after the last time. The first
+// time and the least and most free of every block sit in arrays of their own, which is all a
+// search reads of the blocks it skips
+template <typename Time>
+class ResourceProfile {
+public:
+    explicit ResourceProfile(uint32_t capacity) {
+        blocks.push_back({ { Time() }, { capacity } });
+        blockStart.push_back(Time());
+        leastFree.push_back(capacity);
+        mostFree.push_back(capacity);
+    }
+
+    // First time s at or after from such that at least amount is free over [s, to) and over
+    // [s, s + length). Walks the times from from on once, and skips the blocks that are short
+    // all through or have enough free all through without looking inside
+    Time firstWindow(Time from, Time to, Time length, int64_t amount) const {
+        auto [b, k] = locate(from);
+        Time start = from;
+        for (; b < blocks.size(); ++b, k = 0) {
+            bool lastBlock = b + 1 == blocks.size();
+            if (mostFree[b] < amount) {
+                start = lastBlock ? blocks[b].times.back() : blockStart[b + 1];
+                continue;
+            }
+            if (leastFree[b] >= amount && k == 0) {
+                if (lastBlock || (blockStart[b + 1] >= to && blockStart[b + 1] - start >= length)) return start;
+                continue;
+            }
+            const Block& block = blocks[b];
+            for (; k < block.times.size(); ++k) {
+                bool last = k + 1 == block.times.size();
+                Time next = last ? (lastBlock ? Time() : blockStart[b + 1]) : block.times[k + 1];
+                if (block.free[k] < amount) start = last && lastBlock ? block.times[k] : next;
+                else if ((last && lastBlock) || (next >= to && next - start >= length)) return start;
+            }
         }
+        return start;
     }
-}
 
-// Gets the late finish time
-int getLateFinishScore(const Task& task, const vector<Task>& taskList) {
-    // No successors -> end of project -> LF=EF
-    if (task.successors.empty()) return task.EF; 
+    // Takes amount out of what is free over [from, to)
+    void reserve(Time from, Time to, int64_t amount) {
+        addTime(to);
+        addTime(from);
+        auto [b, k] = locate(from);
+        for (; b < blocks.size() && blockStart[b] < to; ++b, k = 0) {
+            Block& block = blocks[b];
+            for (; k < block.times.size() && block.times[k] < to; ++k) block.free[k] -= amount;
+            findBounds(b);
+        }
+    }
+
+private:
+    // A block is split in two once it holds more times than this
+    static constexpr size_t maxBlockSize = 64;
+
+    struct Block {
+        vector<Time> times;
+        vector<int64_t> free;
+    };
+
+    vector<Block> blocks;
+    vector<Time> blockStart; // First time of every block
+    vector<int64_t> leastFree;
+    vector<int64_t> mostFree;
+
+    void findBounds(size_t b) {
+        auto [least, most] = minmax_element(blocks[b].free.begin(), blocks[b].free.end());
+        leastFree[b] = *least;
+        mostFree[b] = *most;
+    }
+
+    // Block and position in it of the last time at or before t
+    pair<size_t, size_t> locate(Time t) const {
+        size_t b = upper_bound(blockStart.begin(), blockStart.end(), t) - blockStart.begin() - 1;
+        const vector<Time>& times = blocks[b].times;
+        return { b, upper_bound(times.begin(), times.end(), t) - times.begin() - 1 };
+    }
+
+    // Makes t one of the times, without changing what is free at it
+    void addTime(Time t) {
+        auto [b, k] = locate(t);
+        Block& block = blocks[b];
+        if (block.times[k] == t) return;
+        int64_t free = block.free[k];
+        block.times.insert(block.times.begin() + k + 1, t);
+        block.free.insert(block.free.begin() + k + 1, free);
+        if (block.times.size() <= maxBlockSize) return;
+
+        size_t half = block.times.size() / 2;
+        Block second;
+        second.times.assign(block.times.begin() + half, block.times.end());
+        second.free.assign(block.free.begin() + half, block.free.end());
+        block.times.resize(half);
+        block.free.resize(half);
+        blocks.insert(blocks.begin() + b + 1, move(second));
+        blockStart.insert(blockStart.begin() + b + 1, blocks[b + 1].times[0]);
+        leastFree.insert(leastFree.begin() + b + 1, 0);
+        mostFree.insert(mostFree.begin() + b + 1, 0);
+        findBounds(b);
+        findBounds(b + 1);
+    }
+};
 
-    // A large number so that we gurantee that there is at least a min(x, LF starting) != LF starting
-    int LF = INT_MAX;
+// Which of the tasks ready to be placed the serial schedule generation places first, ties go
+// to the task read first
+enum PriorityRule : uint8_t {
+    LatestFinishTime = 0,    // LFT, the task with the earliest late finish
+    MinimumSlack = 1,        // MSLK, the task with the least slack
+    MostTotalSuccessors = 2, // MTS, the task the most tasks come after, directly or not
+};
 
-    // For each successor task
-    for (const string& sName : task.successors) {
-        const Task& sTask = getTaskFromList(sName, taskList);
+// Number of bits set in mask
+inline int countBits(uint64_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    mask -= (mask >> 1) & 0x5555555555555555;
+    mask = (mask & 0x3333333333333333) + ((mask >> 2) & 0x3333333333333333);
+    mask = (mask + (mask >> 4)) & 0x0F0F0F0F0F0F0F0F;
+    return (int)((mask * 0x0101010101010101) >> 56);
+#else
+    return __builtin_popcountll(mask);
+#endif
+}
 
-        // Compute the late start of the successor
-        int sLS = getLateFinishScore(sTask, taskList) - sTask.duration;
+// Counts the tasks that come after every task, directly or through other tasks, for the
+// MostTotalSuccessors rule
+// Successors reached through different paths must only count once, so the tasks are taken 256
+// at a time: a mask per task collects which of the 256 it leads to, in one sweep back through
+// the topological order from the last of them. Every thread takes its share of the 256s in
+// order, so the masks past the end of its current sweep are still 0
+// Every thread needs a mask and a count per task, 36 bytes per task, so there are only as many
+// threads as fit in maxSuccessorCountBytes (but always one, which needs about as much as the
+// task table itself)
+const size_t maxSuccessorCountBytes = size_t(1) << 30;
 
-        // Takes tha minimum late start of all its successors, which is the LF
-        if (sLS < LF) LF = sLS; 
+vector<uint32_t> countAllSuccessors(const TaskGraph& graph, const vector<TaskId>& order, unsigned threadCount) {
+    const size_t words = 4; // Words per mask
+    const size_t groupSize = words * 64;
+    size_t n = order.size();
+    size_t groupCount = (n + groupSize - 1) / groupSize;
+    size_t threadBytes = max<size_t>(1, n * (words * sizeof(uint64_t) + sizeof(uint32_t)));
+    unsigned threads = (unsigned)max<size_t>(1, min({ (size_t)threadCount, groupCount, maxSuccessorCountBytes / threadBytes }));
+    vector<vector<uint32_t>> counts(threads);
+    runOnThreads(threads, [&](unsigned t) {
+        vector<uint64_t> reaches(n * words, 0);
+        vector<uint32_t>& count = counts[t];
+        count.assign(n, 0);
+        for (size_t group = t; group < groupCount; group += threads) {
+            size_t first = group * groupSize;
+            for (size_t p = min(n, first + groupSize); p-- > 0;) {
+                TaskId i = order[p];
+                uint64_t reached[words] = {};
+                for (TaskId s : graph.successors(i)) {
+                    for (size_t w = 0; w < words; ++w) reached[w] |= reaches[s * words + w];
+                }
+                int total = 0;
+                for (size_t w = 0; w < words; ++w) {
+                    reaches[i * words + w] = reached[w];
+                    total += countBits(reached[w]);
+                }
+                count[i] += total;
+                if (p >= first) reaches[i * words + (p - first) / 64] |= uint64_t(1) << ((p - first) % 64);
+            }
+        }
+    });
+    for (unsigned t = 1; t < threads; ++t) {
+        for (size_t i = 0; i < n; ++i) counts[0][i] += counts[t][i];
     }
-    return LF;
+    return move(counts[0]);
 }
 
-// Updates all late start and finish of task structure in task list by reference
-void updateAllLateVars(vector<Task>& taskList) {
-    // For each task in our task list
-    for (Task& task : taskList){
-        // Update late start (LS) and late finish (LF)
-        task.LF = getLateFinishScore(task, taskList);
-        task.LS = task.LF - task.duration; 
+// Start and finish of every task in a resource-constrained schedule
+template <typename Time>
+struct ResourceSchedule {
+    vector<Time> start;
+    vector<Time> finish;
+};
+
+// Places every task with the serial schedule generation scheme, the CPM schedule of the
+// project must be final
+// A task is placed where the passes would place it after its dependencies, with its calendar
+// and constraint, and then moved on to the first time from which every resource it needs has
+// enough free until it finishes. A task holds its resources from its start to its finish,
+// the units its calendar doesn't work included. The placing happens in a copy of the task
+// table, whose early times become the schedule
+template <typename Time>
+ResourceSchedule<Time> scheduleResources(const Project<Time>& project, const vector<TaskId>& order, PriorityRule rule, unsigned threadCount) {
+    const TaskTable<Time>& tasks = project.tasks;
+    const LinkedTaskGraph<Time>& graph = project.graph;
+    size_t n = tasks.size();
+
+    vector<uint32_t> readRank(n);
+    for (size_t k = 0; k < n; ++k) readRank[getTaskInReadOrder(project, k)] = (uint32_t)k;
+    vector<uint32_t> successorCounts;
+    if (rule == MostTotalSuccessors) successorCounts = countAllSuccessors(graph, order, threadCount);
+
+    // Whether task a goes after task b, the ready queue pops the task that goes first
+    auto goesAfter = [&](TaskId a, TaskId b) {
+        if (rule == LatestFinishTime && tasks.LF[a] != tasks.LF[b]) return tasks.LF[b] < tasks.LF[a];
+        if (rule == MinimumSlack && tasks.slack[a] != tasks.slack[b]) return tasks.slack[b] < tasks.slack[a];
+        if (rule == MostTotalSuccessors && successorCounts[a] != successorCounts[b]) return successorCounts[a] < successorCounts[b];
+        return readRank[b] < readRank[a];
+    };
+    priority_queue<TaskId, vector<TaskId>, decltype(goesAfter)> ready(goesAfter);
+    vector<uint32_t> remaining(n);
+    for (TaskId i = 0; i < n; ++i) {
+        remaining[i] = (uint32_t)graph.predecessors(i).size();
+        if (remaining[i] == 0) ready.push(i);
     }
+
+    TaskTable<Time> placed = tasks;
+    vector<ResourceProfile<Time>> profiles(tasks.capacities.begin(), tasks.capacities.end());
+    runPass(placed, graph, [&](auto linked, auto placement) {
+        while (!ready.empty()) {
+            TaskId i = ready.top();
+            ready.pop();
+            updateEarlyVars<decltype(linked)::value>(placed, graph, i, placement);
+
+            // Move the task on to the first time any of its resources has enough free from until
+            // there is no resource left that moves it. A later start never finishes earlier and
+            // never runs for less than the duration, so no start skipped over could fit. In a
+            // calendar the task may run for longer from where it moved to, which the next round
+            // checks again
+            const ResourceDemand* demands = tasks.demands.data() + tasks.firstDemand[i];
+            size_t demandCount = placed.ES[i] < placed.EF[i] ? tasks.demandCount[i] : 0;
+            for (size_t k = 0; k < demandCount;) {
+                Time start = profiles[demands[k].resource].firstWindow(placed.ES[i], placed.EF[i], placed.duration[i], demands[k].amount);
+                if (start == placed.ES[i]) {
+                    ++k;
+                    continue;
+                }
+                placement.placeEarly(placed, i, start, Time());
+                k = 0;
+            }
+            for (size_t k = 0; k < demandCount; ++k) profiles[demands[k].resource].reserve(placed.ES[i], placed.EF[i], demands[k].amount);
+
+            for (TaskId s : graph.successors(i)) {
+                if (--remaining[s] == 0) ready.push(s);
+            }
+        }
+    });
+    return { move(placed.ES), move(placed.EF) };
 }
 
-// Update slack of each task by reference
-void updateAllSlack(vector<Task>& taskList){
-    // For each task in our task list
-    for (Task& task : taskList){
-        // Update slack (late start - early start)
-        task.slack = task.LS - task.ES;
+// Prints how many tasks have negative slack, which happens when they can't meet a constraint or
+// the deadline, and the task that misses it by the most
+template <typename Time>
+void reportNegativeSlack(const Project<Time>& project) {
+    const TaskTable<Time>& taskList = project.tasks;
+    if (!taskList.constrained) return;
+
+    size_t count = 0;
+    TaskId worst = noTask;
+    for (TaskId i = 0; i < taskList.size(); ++i) {
+        if (!(taskList.slack[i] < Time())) continue;
+        count++;
+        if (worst == noTask || taskList.slack[i] < taskList.slack[worst]) worst = i;
     }
+    if (count == 0) return;
+    cout << count << " tasks have negative slack, the most is " << showTime(taskList.slack[worst])
+         << " on task " << project.names.name(taskList.name[worst]) << endl;
 }
 
 // Outputs task details
-// name, duration, ES, EF, LS, LF, slack
-void outputTaskCSV(const vector<Task>& taskList, const string& filename = "output.csv") {
+// name, duration, ES, EF, LS, LF, slack, free float, critical (1 or 0), and the start and
+// finish in the resource-constrained schedule when there is one
+template <typename Time>
+void outputTaskCSV(const Project<Time>& project, const string& filename = "output.csv", const ResourceSchedule<Time>* resourceSchedule = nullptr) {
+    const TaskTable<Time>& taskList = project.tasks;
     ofstream file(filename);
     if (!file.is_open()) {
         cerr << "Failed to open file for writing: " << filename << endl;
@@ -243,17 +3692,22 @@ void outputTaskCSV(const vector<Task>& taskList, const string& filename = "outpu
     }
 
     // Write header
-    file << "task,duration,ES,EF,LS,LF,slack\n";
+    file << "task,duration,ES,EF,LS,LF,slack,free_float,critical" << (resourceSchedule ? ",start,finish\n" : "\n");
 
     // Write task rows
-    for (const auto& t : taskList) {
-        file << t.name << "," 
-             << t.duration << ","
-             << t.ES << ","
-             << t.EF << ","
-             << t.LS << ","
-             << t.LF << ","
-             << t.slack << "\n";
+    for (size_t k = 0; k < taskList.size(); ++k) {
+        TaskId i = getTaskInReadOrder(project, k);
+        file << project.names.name(taskList.name[i]) << "," 
+             << showTime(taskList.duration[i]) << ","
+             << showTime(taskList.ES[i]) << ","
+             << showTime(taskList.EF[i]) << ","
+             << showTime(taskList.LS[i]) << ","
+             << showTime(taskList.LF[i]) << ","
+             << showTime(taskList.slack[i]) << ","
+             << showTime(taskList.freeFloat[i]) << ","
+             << (int)taskList.critical[i];
+        if (resourceSchedule) file << "," << showTime(resourceSchedule->start[i]) << "," << showTime(resourceSchedule->finish[i]);
+        file << "\n";
     }
 
     file.close();
@@ -265,13 +3719,30 @@ void outputTaskCSV(const vector<Task>& taskList, const string& filename = "outpu
 //      showing project schedules, task dependencies, and progress over time
 // Gantt-chart for project management: https://en.wikipedia.org/wiki/Gantt_chart
 // NOTE: This is not exactly a Gantt-chart as csv can't fully express these charts, I used a very simplified model instead.
-// Each column is a time unit; C = Tasks on critical path, X = task active, - = inactive
-void outputTimelineCSV(const vector<Task>& taskList, const string& filename = "timeline.csv") {
-    // Determine project length
-    int projectLength = 0;
-    for (const auto& t : taskList) {
-        if (t.EF > projectLength) projectLength = t.EF;
+// Each column is a time unit; C = Tasks on critical path, X = task active, - = inactive (which
+// includes the units between ES and EF that the calendar of the task doesn't work)
+// Tasks run from their start to their finish in the resource-constrained schedule if there is one
+// The file has a cell per task and time unit, so a timeline of more than this many cells is
+// skipped instead of filling the disk, eg. a long chain in int64 or double time
+const double maxTimelineCells = 1e8;
+
+template <typename Time>
+void outputTimelineCSV(const Project<Time>& project, const string& filename = "timeline.csv", const ResourceSchedule<Time>* resourceSchedule = nullptr) {
+    const TaskTable<Time>& taskList = project.tasks;
+    const vector<Time>& starts = resourceSchedule ? resourceSchedule->start : taskList.ES;
+    const vector<Time>& finishes = resourceSchedule ? resourceSchedule->finish : taskList.EF;
+    // Determine project length, in whole time units
+    Time projectEnd{};
+    for (Time EF : finishes) {
+        if (EF > projectEnd) projectEnd = EF;
+    }
+    double projectUnits = ceil(TimeTraits<Time>::toDouble(projectEnd));
+    if (!(projectUnits * (double)taskList.size() <= maxTimelineCells)) {
+        cout << "Timeline skipped, " << taskList.size() << " tasks over " << showTime(projectEnd) << " time units would take more than "
+             << (uint64_t)maxTimelineCells << " cells" << endl;
+        return;
     }
+    int64_t projectLength = (int64_t)projectUnits;
 
     ofstream file(filename);
     if (!file.is_open()) {
@@ -281,17 +3752,27 @@ void outputTimelineCSV(const vector<Task>& taskList, const string& filename = "t
 
     // Write header row: Time units
     file << "Task";
-    for (int t = 0; t < projectLength; ++t) {
+    for (int64_t t = 0; t < projectLength; ++t) {
         file << "," << t;
     }
     file << "\n";
 
+    auto works = [&](TaskId i, int64_t time) {
+        if constexpr (is_integral_v<Time>) {
+            if (!taskList.calendars.empty()) return taskList.calendars[taskList.calendar[i]].works(time);
+        }
+        return true;
+    };
+
     // Write task timeline rows
-    for (const auto& t : taskList) {
-        file << t.name;
-        for (int time = 0; time < projectLength; ++time) {
-            if (time >= t.ES && time < t.EF){ 
-                if (t.slack == 0) file << ",C"; // critical task
+    for (size_t k = 0; k < taskList.size(); ++k) {
+        TaskId i = getTaskInReadOrder(project, k);
+        file << project.names.name(taskList.name[i]);
+        double ES = TimeTraits<Time>::toDouble(starts[i]);
+        double EF = TimeTraits<Time>::toDouble(finishes[i]);
+        for (int64_t time = 0; time < projectLength; ++time) {
+            if (time >= ES && time < EF && works(i, time)){ 
+                if (taskList.critical[i]) file << ",C"; // critical task
                 else file << ",X"; // task active
             }
             else file << ",-"; // task inactive
@@ -303,18 +3784,367 @@ void outputTimelineCSV(const vector<Task>& taskList, const string& filename = "t
     cout << "Timeline written to " << filename << endl;
 }
 
-int main() {
-    vector<Task> tasks = loadCSV("tasks.csv");
+// Command line options
+// One what-if edit of the command line, the task and the new duration or dependency (empty
+// for --remove-task)
+struct ScheduleEdit {
+    string option;
+    string task;
+    string value;
+};
+
+struct Options {
+    bool compile = false;
+    vector<string> files;               // Input (and for compile output) file names
+    unsigned threads = defaultThreadCount();
+    string engine = "serial";           // serial, fused, levels or dataflow
+    bool timings = false;
+    bool renumber = false;
+    bool reduce = false;
+    string timeType;                    // int32, int64, fixed or double, empty for a compiled project's own (or int32)
+    string calendarFile;                // Calendars csv the tasks are scheduled in, empty if every time unit is worked
+    string deadline;                    // Latest finish of the project, empty if there is none
+    string resourceFile;                // Resources csv the tasks share, empty if they share none
+    PriorityRule priority = LatestFinishTime; // Rule that orders the tasks when scheduling with resources
+    vector<ScheduleEdit> edits;         // --set, --add-dep, --remove-dep, --add-task and --remove-task in the order given, applied after scheduling
+};
+
+void printUsage() {
+    cerr << "usage: elixir [options] [file]                     schedule a csv or compiled project (tasks.csv by default)" << endl
+         << "       elixir [options] compile [input] [output]   compile a csv into a project file (tasks.csv -> tasks.elx)" << endl
+         << "options:" << endl
+         << "    --threads N     threads used for loading and the parallel engines (default: one per core)" << endl
+         << "    --engine NAME   serial (default), fused (two sweeps), levels (parallel, level by level)" << endl
+         << "                    or dataflow (parallel, work stealing)" << endl
+         << "    --time TYPE     int32 (default), int64, fixed (3 decimals) or double, compiled projects keep theirs" << endl
+         << "    --calendars F   schedule in the working calendars of the csv F (whole number time types only)," << endl
+         << "                    compiled projects keep the ones they were compiled with" << endl
+         << "    --renumber      renumber the tasks into topological order before scheduling, for cache locality" << endl
+         << "    --reduce        drop dependencies that other dependencies already imply before scheduling" << endl
+         << "    --deadline N    finish the project by N, tasks that can't make it get negative slack" << endl
+         << "    --resources F   also schedule the tasks within the capacities of the resources in the csv F," << endl
+         << "                    compiled projects keep the ones they were compiled with" << endl
+         << "    --priority RULE lft (default, earliest late finish first), slack (least slack first) or" << endl
+         << "                    successors (most successors first), the order tasks get resources in" << endl
+         << "    --set TASK=N    change the duration of TASK to N after scheduling, updating only what it affects" << endl
+         << "    --add-dep TASK=DEP, --remove-dep TASK=DEP" << endl
+         << "                    add or remove the dependency DEP of TASK after scheduling, DEP as in the csv" << endl
+         << "                    (eg. design:SS+2), edits are applied in the order given" << endl
+         << "    --add-task TASK=N, --remove-task TASK" << endl
+         << "                    add a task of duration N without dependencies, or remove a task and its" << endl
+         << "                    dependencies, after scheduling" << endl
+         << "    --timings       print how long every phase took" << endl;
+}
+
+// Parses the command line into options, returns false after printing why if it is invalid
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            string value = argv[++i];
+            auto [end, error] = from_chars(value.data(), value.data() + value.size(), options.threads);
+            if (error != errc() || end != value.data() + value.size() || options.threads == 0) {
+                cerr << "Invalid thread count: " << value << endl;
+                return false;
+            }
+        }
+        else if (arg == "--engine" && i + 1 < argc) {
+            options.engine = argv[++i];
+            if (options.engine != "serial" && options.engine != "fused" && options.engine != "levels" && options.engine != "dataflow") {
+                cerr << "Unknown engine: " << options.engine << endl;
+                return false;
+            }
+        }
+        else if ((arg == "--set" || arg == "--add-task" || arg == "--add-dep" || arg == "--remove-dep") && i + 1 < argc) {
+            string value = argv[++i];
+            bool durationEdit = arg == "--set" || arg == "--add-task";
+            size_t equals = durationEdit ? value.rfind('=') : value.find('=');
+            if (equals == string::npos || equals == 0 || equals + 1 == value.size()) {
+                cerr << "Invalid " << (durationEdit ? "task duration, expected TASK=N: " : "dependency change, expected TASK=DEP: ") << value << endl;
+                return false;
+            }
+            options.edits.push_back({ arg, value.substr(0, equals), value.substr(equals + 1) });
+        }
+        else if (arg == "--remove-task" && i + 1 < argc) {
+            options.edits.push_back({ arg, argv[++i], "" });
+        }
+        else if (arg == "--time" && i + 1 < argc) {
+            options.timeType = argv[++i];
+            if (!visitTimeType(options.timeType, 0, [](auto) {})) {
+                cerr << "Unknown time type: " << options.timeType << endl;
+                return false;
+            }
+        }
+        else if (arg == "--calendars" && i + 1 < argc) {
+            options.calendarFile = argv[++i];
+        }
+        else if (arg == "--deadline" && i + 1 < argc) {
+            options.deadline = argv[++i];
+        }
+        else if (arg == "--resources" && i + 1 < argc) {
+            options.resourceFile = argv[++i];
+        }
+        else if (arg == "--priority" && i + 1 < argc) {
+            string rule = argv[++i];
+            if (rule == "lft") options.priority = LatestFinishTime;
+            else if (rule == "slack") options.priority = MinimumSlack;
+            else if (rule == "successors") options.priority = MostTotalSuccessors;
+            else {
+                cerr << "Unknown priority rule: " << rule << endl;
+                return false;
+            }
+        }
+        else if (arg == "--timings") {
+            options.timings = true;
+        }
+        else if (arg == "--renumber") {
+            options.renumber = true;
+        }
+        else if (arg == "--reduce") {
+            options.reduce = true;
+        }
+        else if (arg == "compile" && i == 1) {
+            options.compile = true;
+        }
+        else if (arg.size() > 1 && arg[0] == '-') {
+            cerr << "Unknown option: " << arg << endl;
+            printUsage();
+            return false;
+        }
+        else {
+            options.files.push_back(arg);
+        }
+    }
+
+    if (options.files.size() > (options.compile ? 2u : 1u)) {
+        printUsage();
+        return false;
+    }
+
+    // A dependency that --reduce dropped as implied may be needed again once what implied it is gone
+    bool removes = any_of(options.edits.begin(), options.edits.end(), [](const ScheduleEdit& edit) { return edit.option == "--remove-dep" || edit.option == "--remove-task"; });
+    if (options.reduce && removes) {
+        cerr << "--reduce can't be combined with --remove-dep or --remove-task, a dropped dependency may be needed again" << endl;
+        return false;
+    }
+    return true;
+}
+
+// Prints how long every phase of a run took, when asked to
+class PhaseTimer {
+public:
+    explicit PhaseTimer(bool enabled) : enabled(enabled), start(chrono::steady_clock::now()) {}
+
+    void lap(const char* phase) {
+        auto now = chrono::steady_clock::now();
+        if (enabled) cout << phase << ": " << chrono::duration<double, milli>(now - start).count() << " ms" << endl;
+        start = now;
+    }
+
+private:
+    bool enabled;
+    chrono::steady_clock::time_point start;
+};
+
+// Applies the edits of the command line to a scheduled project in the order they were given
+// Duration changes alone keep the graph as it is and go straight to a ScheduleUpdater, while
+// task and dependency changes need the graph in a form that can grow and go through a ProjectEditor,
+// which writes the graph back and leaves order a topological order of it
+template <typename Time>
+void applyEdits(Project<Time>& project, vector<TaskId>& order, const vector<ScheduleEdit>& edits) {
+    auto parseDuration = [](const string& value) {
+        Time duration;
+        if (!TimeTraits<Time>::parse(value, duration) || duration < Time()) throw runtime_error("Invalid duration change, " + value + " is not " + TimeTraits<Time>::description);
+        return duration;
+    };
+    bool durationsOnly = all_of(edits.begin(), edits.end(), [](const ScheduleEdit& edit) { return edit.option == "--set"; });
+    if (durationsOnly) {
+        ScheduleUpdater updater(project.tasks, project.graph, order);
+        for (const ScheduleEdit& edit : edits) updater.setDuration(getTaskIndex(edit.task, project), parseDuration(edit.value));
+        return;
+    }
+
+    ProjectEditor<Time> editor(project, order);
+    for (const ScheduleEdit& edit : edits) {
+        if (edit.option == "--add-task") {
+            editor.addTask(edit.task, parseDuration(edit.value));
+            continue;
+        }
+        TaskId task = getTaskIndex(edit.task, project);
+        if (edit.option == "--remove-task") {
+            editor.removeTask(task);
+            continue;
+        }
+        if (edit.option == "--set") {
+            editor.setDuration(task, parseDuration(edit.value));
+            continue;
+        }
+
+        // The dependency is written as in the csv, eg. "b", "b:SS" or "b:FF+2"
+        string_view name = edit.value;
+        LinkType type = FinishToStart;
+        Time lag{};
+        size_t colon = name.rfind(':');
+        string_view link = colon == string_view::npos ? string_view() : name.substr(colon + 1);
+        if (link.size() >= 2 && TaskRowParser<Time>::parseLinkType(link.substr(0, 2), type)) {
+            string_view lagField = link.substr(2);
+            if (!lagField.empty() && !TaskRowParser<Time>::parseLag(lagField, lag)) {
+                throw runtime_error("Invalid dependency change, lag \"" + string(lagField) + "\" is not + or - followed by " + TimeTraits<Time>::description);
+            }
+            name = name.substr(0, colon);
+        }
+        TaskId dependency = getTaskIndex(name, project);
+        if (edit.option == "--remove-dep") {
+            if (!editor.removeDependency(task, dependency)) throw runtime_error("Task " + edit.task + " doesn't depend on " + string(name));
+        }
+        else if (!editor.addDependency(task, dependency, type, lag)) {
+            throw runtime_error("Task " + edit.task + " can't depend on " + string(name) + ", that would create a dependency cycle");
+        }
+    }
+    editor.storeGraph();
+    order = getTopologicalOrder(project.graph);
+}
+
+// Runs the program with every duration and time of type Time
+template <typename Time>
+int run(const Options& options) {
+    string input = options.files.empty() ? "tasks.csv" : options.files[0];
+    PhaseTimer timer(options.timings);
+
+    // Invalid input is reported in full instead of crashing halfway through
+    Project<Time> project;
+    try {
+        CalendarList calendars;
+        if (!options.calendarFile.empty()) {
+            if (!is_integral_v<Time>) throw runtime_error(string("Calendars need a whole number time type, not ") + TimeTraits<Time>::name);
+            if (!options.compile && isProjectFile(input)) throw runtime_error("A compiled project keeps the calendars it was compiled with, compile it again to change them");
+            calendars = loadCalendarCSV(options.calendarFile);
+        }
+        ResourceList resources;
+        if (!options.resourceFile.empty()) {
+            if (!options.compile && isProjectFile(input)) throw runtime_error("A compiled project keeps the resources it was compiled with, compile it again to change them");
+            resources = loadResourceCSV(options.resourceFile);
+        }
+        project = options.compile ? loadCSV<Time>(input, options.threads, calendars, resources) : loadProject<Time>(input, options.threads, calendars, resources);
+    }
+    catch (const exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    timer.lap("load");
+
+    // "compile" stops once the project file is written
+    if (options.compile) {
+        if (!writeProjectFile(project, options.files.size() > 1 ? options.files[1] : "tasks.elx")) return 1;
+        timer.lap("compile");
+        return 0;
+    }
+    TaskTable<Time>& tasks = project.tasks;
+    if (!options.deadline.empty()) {
+        if (!TimeTraits<Time>::parse(options.deadline, tasks.deadline)) {
+            cerr << "Invalid deadline, " << options.deadline << " is not " << TimeTraits<Time>::description << endl;
+            return 1;
+        }
+        tasks.findConstraints();
+    }
+
+    // A project with a dependency cycle has no schedule at all
+    vector<vector<TaskId>> cycles = findDependencyCycles(project.graph);
+    if (!cycles.empty()) {
+        printDependencyCycles(project, cycles);
+        return 1;
+    }
+    timer.lap("cycle check");
+
+    // Order the tasks once so every pass is a single sweep over the graph
+    vector<TaskId> order;
+    try {
+        order = getTopologicalOrder(project.graph);
+    }
+    catch (const exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    timer.lap("topological order");
+    if (options.renumber) {
+        renumberTasks(project, order);
+        timer.lap("renumber");
+    }
+    if (options.reduce) {
+        size_t removed = removeImpliedDependencies(project.graph, order, options.threads);
+        cout << "Removed " << removed << " implied dependencies" << endl;
+        timer.lap("reduce");
+    }
 
     // Forward and backward passes
-    updateAllEarlyVars(tasks);
-    populateSuccessors(tasks);
-    updateAllLateVars(tasks);
-    updateAllSlack(tasks);
+    if (options.engine == "fused") {
+        updateAllFused(tasks, project.graph, order);
+    }
+    else if (options.engine == "levels") {
+        TaskLevels levels = getTopologicalLevels(project.graph, order);
+        timer.lap("levels");
+        updateAllEarlyVarsParallel(tasks, project.graph, levels, options.threads);
+        updateAllLateVarsParallel(tasks, project.graph, levels, options.threads);
+    }
+    else if (options.engine == "dataflow") {
+        updateAllEarlyVarsDataflow(tasks, project.graph, options.threads);
+        updateAllLateVarsDataflow(tasks, project.graph, options.threads);
+    }
+    else {
+        updateAllEarlyVars(tasks, project.graph, order);
+        updateAllLateVars(tasks, project.graph, order);
+    }
+    if (options.engine != "fused") {
+        updateAllSlack(tasks);
+        updateAllFreeFloat(tasks, project.graph);
+    }
+    timer.lap("passes");
+
+    // What-if edits only touch the tasks they affect
+    if (!options.edits.empty()) {
+        try {
+            applyEdits(project, order, options.edits);
+        }
+        catch (const exception& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+        timer.lap("edits");
+    }
+    reportNegativeSlack(project);
+
+    // Resources can hold tasks back past their ES, so they get a schedule of their own
+    ResourceSchedule<Time> resourceSchedule;
+    bool hasResources = !tasks.capacities.empty();
+    if (hasResources) {
+        resourceSchedule = scheduleResources(project, order, options.priority, options.threads);
+        Time criticalPathEnd{};
+        Time resourceEnd{};
+        for (TaskId i = 0; i < tasks.size(); ++i) {
+            if (tasks.EF[i] > criticalPathEnd) criticalPathEnd = tasks.EF[i];
+            if (resourceSchedule.finish[i] > resourceEnd) resourceEnd = resourceSchedule.finish[i];
+        }
+        cout << "Resource-constrained schedule finishes at " << showTime(resourceEnd) << ", the critical path at " << showTime(criticalPathEnd) << endl;
+        timer.lap("resources");
+    }
 
     // Output CSV files
-    outputTaskCSV(tasks, "output.csv");
-    outputTimelineCSV(tasks, "timeline.csv");
+    outputTaskCSV(project, "output.csv", hasResources ? &resourceSchedule : nullptr);
+    outputTimelineCSV(project, "timeline.csv", hasResources ? &resourceSchedule : nullptr);
+    timer.lap("output");
 
     return 0;
-}
\ No newline at end of file
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) return 1;
+
+    // A compiled project is scheduled in the time type it was compiled with, unless told otherwise
+    string input = options.files.empty() ? "tasks.csv" : options.files[0];
+    uint32_t compiledType = options.compile ? 0 : readProjectTimeType(input);
+    int result = 1;
+    auto runWith = [&](auto zero) { result = run<decltype(zero)>(options); };
+    if (!visitTimeType(options.timeType, options.timeType.empty() ? compiledType : 0, runWith)) runWith(int32_t());
+    return result;
+}